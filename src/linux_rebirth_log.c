@@ -0,0 +1,109 @@
+#include <pthread.h>
+#include <time.h>
+
+// How long the writer sleeps once the log is empty
+#define PLAY_LOG_WAIT_MS 50
+#define PLAY_LOG_VERSION 1
+
+// Log files start with this, then the events as in memory
+typedef struct
+{
+  char magic[4];
+  u16 version;
+  u16 event_size;
+} play_log_header_t;
+
+typedef struct
+{
+  b32 running;
+  b32 quit;
+  pthread_t thread;
+  FILE *file;
+  play_log_t *log;
+} play_logger_t;
+
+global play_logger_t play_logger;
+
+internal void
+write_play_events(play_log_t *log)
+{
+  u32 tail = log->tail;
+  u32 head = __atomic_load_n(&log->head, __ATOMIC_ACQUIRE);
+
+  while(tail != head)
+  {
+    // Up to the end of the buffer, the rest wraps around to the start
+    u32 start = tail & (PLAY_LOG_SIZE - 1);
+    u32 count = head - tail;
+    count = (start + count > PLAY_LOG_SIZE) ? PLAY_LOG_SIZE - start : count;
+
+    fwrite(&log->events[start], sizeof(play_event_t), count, play_logger.file);
+    tail += count;
+  }
+
+  if(tail != log->tail)
+  {
+    // Whatever was taken is on disk even if the game gets killed
+    fflush(play_logger.file);
+    __atomic_store_n(&log->tail, tail, __ATOMIC_RELEASE);
+  }
+}
+
+internal void *
+run_play_logger(void *data)
+{
+  (void)data;
+
+  struct timespec wait = {0, PLAY_LOG_WAIT_MS * 1000000};
+  while(!__atomic_load_n(&play_logger.quit, __ATOMIC_ACQUIRE))
+  {
+    write_play_events(play_logger.log);
+    nanosleep(&wait, 0);
+  }
+
+  write_play_events(play_logger.log);
+  return 0;
+}
+
+internal play_log_t *
+init_play_log(char *path)
+{
+  play_logger.file = fopen(path, "wb");
+  if(!play_logger.file)
+  {
+    return 0;
+  }
+
+  play_log_header_t header = {{'R', 'B', 'E', 'V'}, PLAY_LOG_VERSION, sizeof(play_event_t)};
+  fwrite(&header, sizeof(header), 1, play_logger.file);
+
+  play_logger.log = calloc(1, sizeof(play_log_t));
+  if(pthread_create(&play_logger.thread, 0, run_play_logger, 0))
+  {
+    fclose(play_logger.file);
+    free(play_logger.log);
+    return 0;
+  }
+
+  play_logger.running = true;
+  return play_logger.log;
+}
+
+internal void
+quit_play_log()
+{
+  if(play_logger.running)
+  {
+    __atomic_store_n(&play_logger.quit, true, __ATOMIC_RELEASE);
+    pthread_join(play_logger.thread, 0);
+    fclose(play_logger.file);
+
+    if(play_logger.log->dropped)
+    {
+      printf("%u events didn't fit in the log and were left out.\n", play_logger.log->dropped);
+    }
+
+    free(play_logger.log);
+    play_logger.running = false;
+  }
+}
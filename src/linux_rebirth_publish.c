@@ -0,0 +1,74 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+typedef struct
+{
+  char name[64];
+  inspect_region_t *region;
+} publisher_t;
+
+global publisher_t publisher;
+
+// The game goes on without a region
+internal void
+init_publishing(level_t *level)
+{
+  snprintf(publisher.name, sizeof(publisher.name), INSPECT_NAME_FORMAT, (i32)getpid());
+
+  i32 fd = shm_open(publisher.name, O_CREAT | O_RDWR | O_TRUNC, 0600);
+  if(fd < 0)
+  {
+    return;
+  }
+
+  void *region = MAP_FAILED;
+  if(!ftruncate(fd, sizeof(inspect_region_t)))
+  {
+    region = mmap(0, sizeof(inspect_region_t), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+
+  close(fd);
+
+  if(region == MAP_FAILED)
+  {
+    shm_unlink(publisher.name);
+    return;
+  }
+
+  // The level never changes while the game runs
+  publisher.region = (inspect_region_t *)region;
+  publisher.region->level = *level;
+  __atomic_store_n(&publisher.region->version, INSPECT_VERSION, __ATOMIC_RELEASE);
+}
+
+// Called once a frame, never waits on readers
+internal void
+publish_game_state(rebirth_ctx_t *ctx)
+{
+  inspect_region_t *region = publisher.region;
+  if(!region)
+  {
+    return;
+  }
+
+  u32 sequence = region->sequence;
+  __atomic_store_n(&region->sequence, sequence + 1, __ATOMIC_RELAXED);
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+
+  save_game(ctx, &region->snapshot);
+  region->frame++;
+
+  __atomic_store_n(&region->sequence, sequence + 2, __ATOMIC_RELEASE);
+}
+
+internal void
+quit_publishing()
+{
+  if(publisher.region)
+  {
+    munmap(publisher.region, sizeof(inspect_region_t));
+    shm_unlink(publisher.name);
+    publisher.region = 0;
+  }
+}
@@ -0,0 +1,1051 @@
+#include "rebirth.c"
+#include "rebirth_render.c"
+
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#define SERVER_DEFAULT_PORT 2323
+#define SERVER_MAX_EVENTS 256
+#define SERVER_READ_SIZE 512
+#define SERVER_MAX_THREADS 64
+#define SERVER_REPORT_SECONDS 10
+#define SERVER_DEFAULT_FRAME_BUDGET 1024
+
+// Sessions per chunk, chunks are never given back
+#define SLAB_CHUNK_SIZE (64 * 1024)
+#define CACHE_LINE_SIZE 64
+
+// Drop clients that stop reading
+#define SERVER_MAX_PENDING_OUTPUT (256 * 1024)
+
+#define TELNET_SE 240
+#define TELNET_SB 250
+#define TELNET_WILL 251
+#define TELNET_DONT 254
+#define TELNET_IAC 255
+
+typedef enum
+{
+  telnet_data,
+  telnet_command,
+  telnet_option,
+  telnet_subnegotiation,
+  telnet_subnegotiation_command
+} telnet_state_e;
+
+typedef enum
+{
+  escape_none,
+  escape_started,
+  escape_sequence
+} escape_state_e;
+
+// Fixed size records, taken by the owner and given back by anyone
+typedef struct
+{
+  u32 record_size;
+  u32 chunk_count;
+  void *free;
+  void *returned;
+} slab_t;
+
+// Last winnable game of a soft locked session
+typedef struct __attribute__((aligned(CACHE_LINE_SIZE)))
+{
+  packed_game_t game;
+  u8 home;
+} session_snapshot_t;
+
+// Session kept packed while it waits for keys
+typedef struct __attribute__((aligned(CACHE_LINE_SIZE)))
+{
+  i32 fd;
+
+  // What epoll woke the session up for
+  u32 events;
+
+  // Frames are sent as the changes to the last one, the buffer only exists
+  // while there's something in it left to send
+  terminal_output_t output;
+  u32 output_sent;
+
+  u8 closing;
+  u8 registered;
+  u8 framed;
+
+  // What came in so far, a key can be split over reads
+  u8 telnet_state;
+  u8 escape_state;
+  u8 after_return;
+
+  // The worker whose slab the session came from
+  u8 home;
+
+  session_snapshot_t *last_winnable;
+  packed_game_t game;
+  char message[MAX_LENGTH];
+} session_t;
+
+// Owner takes the oldest session, thieves take from the other end
+typedef struct
+{
+  pthread_mutex_t lock;
+  u32 top;
+  u32 bottom;
+  u32 capacity;
+  session_t **sessions;
+} session_deque_t;
+
+typedef struct
+{
+  pthread_t thread;
+  i32 index;
+  u32 random;
+  u64 task_count;
+  session_deque_t deque;
+
+  // Sessions queued to the worker are taken from its session slab by the
+  // epoll thread, the worker takes snapshots from its own
+  slab_t sessions;
+  slab_t snapshots;
+
+  // The session being run is unpacked here, the spare is for packing its
+  // last winnable game
+  rebirth_ctx_t ctx;
+  rebirth_ctx_t spare;
+
+  // What the client has on its screen is drawn again and the new frame is
+  // diffed against it
+  screen_t shown;
+  screen_t frame;
+
+  // What the frames sent cost, read by the epoll thread for the report
+  u64 frame_count;
+  u64 over_budget_count;
+  u64 largest_frame;
+  u64 frame_bytes[part_count];
+  u64 frame_escapes[part_count];
+} server_worker_t;
+
+typedef struct
+{
+  i32 epoll_fd;
+  i32 listen_fd;
+  u32 session_count;
+  u64 output_size;
+  packed_game_t new_game;
+
+  // Frames that take more bytes than this to send are counted as over it
+  u32 frame_budget;
+
+  i32 worker_count;
+  i32 next_worker;
+  server_worker_t *workers;
+
+  // Workers with nothing to run or steal sleep until a session is queued
+  pthread_mutex_t lock;
+  pthread_cond_t work_queued;
+  u32 queued_count;
+  u32 sleeping_count;
+} server_t;
+
+global server_t server;
+global char *frame_part_names[part_count] = {"other", "room", "items", "player", "inventory", "message"};
+
+// Character at a time mode
+global char telnet_greeting[] =
+{
+  (char)TELNET_IAC, (char)TELNET_WILL, 1,  // Echo
+  (char)TELNET_IAC, (char)TELNET_WILL, 3,  // Suppress go ahead
+  (char)TELNET_IAC, (char)TELNET_DONT, 34  // Linemode
+};
+
+internal void
+init_slab(slab_t *slab, u32 record_size)
+{
+  slab->record_size = record_size;
+}
+
+internal void *
+take_slab_record(slab_t *slab)
+{
+  if(!slab->free)
+  {
+    slab->free = __atomic_exchange_n(&slab->returned, 0, __ATOMIC_ACQUIRE);
+  }
+
+  if(!slab->free)
+  {
+    u8 *chunk = 0;
+    if(posix_memalign((void **)&chunk, CACHE_LINE_SIZE, SLAB_CHUNK_SIZE))
+    {
+      return 0;
+    }
+
+    for(u32 at = 0; at + slab->record_size <= SLAB_CHUNK_SIZE; at += slab->record_size)
+    {
+      *(void **)(chunk + at) = slab->free;
+      slab->free = chunk + at;
+    }
+
+    __atomic_fetch_add(&slab->chunk_count, 1, __ATOMIC_RELAXED);
+  }
+
+  void *result = slab->free;
+  slab->free = *(void **)result;
+  memset(result, 0, slab->record_size);
+
+  return result;
+}
+
+internal void
+give_back_slab_record(slab_t *slab, void *record)
+{
+  void **next = (void **)record;
+  *next = __atomic_load_n(&slab->returned, __ATOMIC_RELAXED);
+  while(!__atomic_compare_exchange_n(&slab->returned, next, record, true, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+internal void
+free_session_output(session_t *session)
+{
+  __atomic_fetch_sub(&server.output_size, session->output.capacity, __ATOMIC_RELAXED);
+  free(session->output.data);
+
+  session->output.data = 0;
+  session->output.count = 0;
+  session->output.capacity = 0;
+  session->output_sent = 0;
+}
+
+internal void
+push_session_output(session_t *session, char *data, u32 count)
+{
+  u32 capacity = session->output.capacity;
+  push_terminal_output(&session->output, data, count);
+  __atomic_fetch_add(&server.output_size, session->output.capacity - capacity, __ATOMIC_RELAXED);
+}
+
+internal void
+free_session_snapshot(session_t *session)
+{
+  if(session->last_winnable)
+  {
+    give_back_slab_record(&server.workers[session->last_winnable->home].snapshots, session->last_winnable);
+    session->last_winnable = 0;
+  }
+}
+
+internal void
+close_session(session_t *session)
+{
+  epoll_ctl(server.epoll_fd, EPOLL_CTL_DEL, session->fd, 0);
+  close(session->fd);
+
+  free_session_output(session);
+  free_session_snapshot(session);
+  give_back_slab_record(&server.workers[session->home].sessions, session);
+  __atomic_fetch_sub(&server.session_count, 1, __ATOMIC_RELAXED);
+}
+
+// Send without waiting, returns false if the client is gone
+internal b32
+flush_session(session_t *session)
+{
+  while(session->output_sent < session->output.count)
+  {
+    ssize_t sent = send(session->fd, session->output.data + session->output_sent,
+                        session->output.count - session->output_sent, MSG_NOSIGNAL);
+    if(sent > 0)
+    {
+      session->output_sent += (u32)sent;
+    }
+    else if(sent < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    else if(sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      break;
+    }
+    else
+    {
+      return false;
+    }
+  }
+
+  if(session->output_sent == session->output.count)
+  {
+    free_session_output(session);
+    return !session->closing;
+  }
+
+  return (session->output.count - session->output_sent) <= SERVER_MAX_PENDING_OUTPUT;
+}
+
+// Sessions are one shot, rearming has to be the last thing a task does
+internal void
+arm_session(session_t *session, i32 operation)
+{
+  session->registered = true;
+
+  struct epoll_event event = {0};
+  event.events = EPOLLIN | EPOLLONESHOT;
+  if(session->output_sent < session->output.count)
+  {
+    event.events |= EPOLLOUT;
+  }
+
+  event.data.ptr = session;
+  epoll_ctl(server.epoll_fd, operation, session->fd, &event);
+}
+
+// Unpack the session into the worker's context
+internal void
+unpack_session(server_worker_t *worker, session_t *session)
+{
+  rebirth_ctx_t *ctx = &worker->ctx;
+  unpack_game(ctx, &session->game);
+  memcpy(ctx->game.message, session->message, sizeof(session->message));
+
+  // The soft lock and the light are worked out again from the game, all that
+  // can't be is the last game that could still be won
+  if(ctx->game.state == state_play)
+  {
+    init_soft_lock(ctx);
+    update_light(ctx);
+
+    if(session->last_winnable)
+    {
+      unpack_game(&worker->spare, &session->last_winnable->game);
+      save_game(&worker->spare, &ctx->soft_lock.last_winnable);
+      ctx->soft_lock.lost = true;
+    }
+  }
+
+  if(session->framed)
+  {
+    render_game(&worker->shown, ctx);
+  }
+  else
+  {
+    clear_screen(&worker->shown);
+  }
+}
+
+internal void
+pack_session(server_worker_t *worker, session_t *session)
+{
+  rebirth_ctx_t *ctx = &worker->ctx;
+  pack_game(ctx, &session->game);
+  memcpy(session->message, ctx->game.message, sizeof(session->message));
+
+  if(ctx->game.state == state_play && ctx->soft_lock.lost)
+  {
+    // The last winnable game stays the same for as long as the game is lost
+    if(!session->last_winnable)
+    {
+      session->last_winnable = take_slab_record(&worker->snapshots);
+      if(session->last_winnable)
+      {
+        session->last_winnable->home = (u8)worker->index;
+        load_game(&worker->spare, &ctx->soft_lock.last_winnable);
+        pack_game(&worker->spare, &session->last_winnable->game);
+      }
+    }
+  }
+  else
+  {
+    free_session_snapshot(session);
+  }
+}
+
+internal void
+add_frame_cost(server_worker_t *worker, frame_cost_t *cost)
+{
+  u64 frame_size = 0;
+  for(u32 part = 0; part < part_count; part++)
+  {
+    frame_size += cost->bytes[part];
+    __atomic_fetch_add(&worker->frame_bytes[part], cost->bytes[part], __ATOMIC_RELAXED);
+    __atomic_fetch_add(&worker->frame_escapes[part], cost->escapes[part], __ATOMIC_RELAXED);
+  }
+
+  __atomic_fetch_add(&worker->frame_count, 1, __ATOMIC_RELAXED);
+  if(frame_size > server.frame_budget)
+  {
+    __atomic_fetch_add(&worker->over_budget_count, 1, __ATOMIC_RELAXED);
+  }
+
+  if(frame_size > worker->largest_frame)
+  {
+    __atomic_store_n(&worker->largest_frame, frame_size, __ATOMIC_RELAXED);
+  }
+}
+
+internal void
+send_session_frame(server_worker_t *worker, session_t *session)
+{
+  if(worker->ctx.game.state == state_quit)
+  {
+    char goodbye[] = "\033[0m\033[2J\033[H\033[?25h";
+    push_session_output(session, goodbye, sizeof(goodbye) - 1);
+    session->closing = true;
+  }
+  else
+  {
+    u32 capacity = session->output.capacity;
+    frame_cost_t cost = {0};
+    render_game(&worker->frame, &worker->ctx);
+    write_screen_changes(&session->output, &worker->shown, &worker->frame, &cost);
+    __atomic_fetch_add(&server.output_size, session->output.capacity - capacity, __ATOMIC_RELAXED);
+    add_frame_cost(worker, &cost);
+  }
+
+  session->framed = true;
+}
+
+// Telnet bytes to game input
+internal i32
+get_session_input(session_t *session, u8 byte)
+{
+  i32 result = input_none;
+
+  switch(session->telnet_state)
+  {
+    case telnet_command:
+    {
+      if(byte >= TELNET_WILL && byte <= TELNET_DONT)
+      {
+        session->telnet_state = telnet_option;
+      }
+      else if(byte == TELNET_SB)
+      {
+        session->telnet_state = telnet_subnegotiation;
+      }
+      else
+      {
+        session->telnet_state = telnet_data;
+      }
+    } break;
+
+    case telnet_option: session->telnet_state = telnet_data; break;
+
+    case telnet_subnegotiation:
+    {
+      if(byte == TELNET_IAC)
+      {
+        session->telnet_state = telnet_subnegotiation_command;
+      }
+    } break;
+
+    case telnet_subnegotiation_command:
+    {
+      session->telnet_state = (byte == TELNET_SE) ? telnet_data : telnet_subnegotiation;
+    } break;
+
+    case telnet_data:
+    {
+      b32 after_return = session->after_return;
+      session->after_return = false;
+
+      if(byte == TELNET_IAC)
+      {
+        session->telnet_state = telnet_command;
+      }
+      else if(session->escape_state == escape_started)
+      {
+        session->escape_state = (byte == '[' || byte == 'O') ? escape_sequence : escape_none;
+      }
+      else if(session->escape_state == escape_sequence)
+      {
+        // Parameters and such come before the letter that ends it
+        if(byte >= 0x40 && byte <= 0x7E)
+        {
+          session->escape_state = escape_none;
+
+          if(byte == 'A')
+          {
+            result = input_up;
+          }
+          else if(byte == 'B')
+          {
+            result = input_down;
+          }
+        }
+      }
+      else if(byte == 27)
+      {
+        session->escape_state = escape_started;
+      }
+      else if(byte == '\r')
+      {
+        session->after_return = true;
+        result = input_enter;
+      }
+      else if(byte == '\n' || byte == 0)
+      {
+        // Clients send a return as CR LF or CR NUL
+        result = after_return ? input_none : input_enter;
+      }
+      else if(byte < 127)
+      {
+        result = byte;
+      }
+    } break;
+  }
+
+  return result;
+}
+
+// Play the keys and send the frame, returns false if the client is gone
+internal b32
+read_session(server_worker_t *worker, session_t *session)
+{
+  rebirth_ctx_t *ctx = &worker->ctx;
+  b32 unpacked = false;
+  b32 needs_frame = !session->framed;
+
+  u8 bytes[SERVER_READ_SIZE];
+
+  for(;;)
+  {
+    ssize_t count = recv(session->fd, bytes, sizeof(bytes), 0);
+    if(count < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    else if(count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      break;
+    }
+    else if(count <= 0)
+    {
+      return false;
+    }
+
+    for(ssize_t i = 0; i < count && !session->closing; i++)
+    {
+      i32 input = get_session_input(session, bytes[i]);
+      if(input != input_none)
+      {
+        if(!unpacked)
+        {
+          unpack_session(worker, session);
+          unpacked = true;
+        }
+
+        if(ctx->game.state == state_quit)
+        {
+          break;
+        }
+
+        game_output_t output = step_game(ctx, input);
+        if(output.hint_asked)
+        {
+          push_message(ctx, "You can't think of anything right now.");
+        }
+
+        needs_frame = true;
+      }
+    }
+  }
+
+  // A burst of keys is answered with one frame
+  if(needs_frame)
+  {
+    if(!unpacked)
+    {
+      unpack_session(worker, session);
+    }
+
+    send_session_frame(worker, session);
+    pack_session(worker, session);
+  }
+
+  return true;
+}
+
+internal void
+run_session(server_worker_t *worker, session_t *session)
+{
+  b32 open = true;
+  if(session->events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+  {
+    open = read_session(worker, session);
+  }
+
+  if(open && flush_session(session))
+  {
+    arm_session(session, session->registered ? EPOLL_CTL_MOD : EPOLL_CTL_ADD);
+  }
+  else
+  {
+    close_session(session);
+  }
+}
+
+internal void
+push_session_deque(session_deque_t *deque, session_t *session)
+{
+  pthread_mutex_lock(&deque->lock);
+
+  if(deque->bottom == deque->capacity)
+  {
+    // Slide what's left down before growing
+    u32 count = deque->bottom - deque->top;
+    memmove(deque->sessions, deque->sessions + deque->top, count * sizeof(session_t *));
+    deque->top = 0;
+    deque->bottom = count;
+
+    if(!deque->capacity || count * 2 > deque->capacity)
+    {
+      deque->capacity = deque->capacity ? deque->capacity * 2 : 1024;
+      deque->sessions = realloc(deque->sessions, deque->capacity * sizeof(session_t *));
+    }
+  }
+
+  deque->sessions[deque->bottom++] = session;
+  pthread_mutex_unlock(&deque->lock);
+}
+
+internal session_t *
+pop_session_deque(session_deque_t *deque)
+{
+  session_t *result = 0;
+  pthread_mutex_lock(&deque->lock);
+
+  if(deque->bottom > deque->top)
+  {
+    result = deque->sessions[deque->top++];
+  }
+
+  pthread_mutex_unlock(&deque->lock);
+  return result;
+}
+
+// Steal the newer half of another worker's queue
+internal session_t *
+steal_session_work(server_worker_t *worker)
+{
+  for(i32 attempt = 0; attempt < server.worker_count; attempt++)
+  {
+    worker->random ^= worker->random << 13;
+    worker->random ^= worker->random >> 17;
+    worker->random ^= worker->random << 5;
+
+    server_worker_t *victim = &server.workers[worker->random % server.worker_count];
+    if(victim == worker)
+    {
+      continue;
+    }
+
+    session_t *stolen[256];
+    u32 stolen_count = 0;
+
+    pthread_mutex_lock(&victim->deque.lock);
+    u32 count = victim->deque.bottom - victim->deque.top;
+    stolen_count = (count + 1) / 2;
+    stolen_count = stolen_count < array_count(stolen) ? stolen_count : array_count(stolen);
+    victim->deque.bottom -= stolen_count;
+    memcpy(stolen, victim->deque.sessions + victim->deque.bottom, stolen_count * sizeof(session_t *));
+    pthread_mutex_unlock(&victim->deque.lock);
+
+    if(stolen_count)
+    {
+      for(u32 i = 1; i < stolen_count; i++)
+      {
+        push_session_deque(&worker->deque, stolen[i]);
+      }
+
+      return stolen[0];
+    }
+  }
+
+  return 0;
+}
+
+internal void
+queue_session(session_t *session, u32 events)
+{
+  session->events = events;
+
+  server_worker_t *worker = &server.workers[server.next_worker];
+  server.next_worker = (server.next_worker + 1) % server.worker_count;
+  push_session_deque(&worker->deque, session);
+
+  __atomic_fetch_add(&server.queued_count, 1, __ATOMIC_SEQ_CST);
+  if(__atomic_load_n(&server.sleeping_count, __ATOMIC_SEQ_CST))
+  {
+    pthread_mutex_lock(&server.lock);
+    pthread_cond_signal(&server.work_queued);
+    pthread_mutex_unlock(&server.lock);
+  }
+}
+
+internal void *
+run_server_worker(void *data)
+{
+  server_worker_t *worker = (server_worker_t *)data;
+
+  for(;;)
+  {
+    session_t *session = pop_session_deque(&worker->deque);
+    if(!session)
+    {
+      session = steal_session_work(worker);
+    }
+
+    if(session)
+    {
+      __atomic_fetch_sub(&server.queued_count, 1, __ATOMIC_SEQ_CST);
+      run_session(worker, session);
+      worker->task_count++;
+    }
+    else
+    {
+      // Count as sleeping before the last look at the queue
+      pthread_mutex_lock(&server.lock);
+      __atomic_fetch_add(&server.sleeping_count, 1, __ATOMIC_SEQ_CST);
+      while(!__atomic_load_n(&server.queued_count, __ATOMIC_SEQ_CST))
+      {
+        pthread_cond_wait(&server.work_queued, &server.lock);
+      }
+      __atomic_fetch_sub(&server.sleeping_count, 1, __ATOMIC_SEQ_CST);
+      pthread_mutex_unlock(&server.lock);
+    }
+  }
+
+  return 0;
+}
+
+internal void
+accept_sessions()
+{
+  for(;;)
+  {
+    i32 fd = accept(server.listen_fd, 0, 0);
+    if(fd < 0)
+    {
+      if(errno == EINTR || errno == ECONNABORTED)
+      {
+        continue;
+      }
+
+      // EAGAIN when there's nobody left, anything else is out of descriptors
+      // or memory and gets another go on the next wakeup
+      break;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    // The session comes from the slab of the worker it's queued to first
+    i32 home = server.next_worker;
+    session_t *session = take_slab_record(&server.workers[home].sessions);
+    if(!session)
+    {
+      close(fd);
+      continue;
+    }
+
+    session->fd = fd;
+    session->home = (u8)home;
+    session->game = server.new_game;
+
+    char clear[] = "\033[0m\033[2J\033[?25l";
+    push_session_output(session, telnet_greeting, sizeof(telnet_greeting));
+    push_session_output(session, clear, sizeof(clear) - 1);
+
+    // The first frame is drawn by a worker like any other, which then
+    // registers the session with epoll
+    __atomic_fetch_add(&server.session_count, 1, __ATOMIC_RELAXED);
+    queue_session(session, EPOLLIN);
+  }
+}
+
+// Print memory per session when it changes
+internal void
+print_server_size(u64 *reported_size, u32 *reported_count)
+{
+  u64 size = __atomic_load_n(&server.output_size, __ATOMIC_RELAXED);
+  for(i32 i = 0; i < server.worker_count; i++)
+  {
+    size += (u64)__atomic_load_n(&server.workers[i].sessions.chunk_count, __ATOMIC_RELAXED) * SLAB_CHUNK_SIZE;
+    size += (u64)__atomic_load_n(&server.workers[i].snapshots.chunk_count, __ATOMIC_RELAXED) * SLAB_CHUNK_SIZE;
+  }
+
+  u32 session_count = __atomic_load_n(&server.session_count, __ATOMIC_RELAXED);
+  if(session_count && (size != *reported_size || session_count != *reported_count))
+  {
+    printf("%u sessions in %llu bytes, %llu bytes per session\n",
+           session_count, (unsigned long long)size, (unsigned long long)(size / session_count));
+    fflush(stdout);
+    *reported_size = size;
+    *reported_count = session_count;
+  }
+}
+
+// Print frame cost per part when frames were sent
+internal void
+print_server_frames(u64 *reported_frame_count)
+{
+  u64 frame_count = 0;
+  u64 over_budget_count = 0;
+  u64 largest_frame = 0;
+  u64 bytes[part_count] = {0};
+  u64 escapes[part_count] = {0};
+  u64 total_bytes = 0;
+  u64 total_escapes = 0;
+
+  for(i32 i = 0; i < server.worker_count; i++)
+  {
+    server_worker_t *worker = &server.workers[i];
+    frame_count += __atomic_load_n(&worker->frame_count, __ATOMIC_RELAXED);
+    over_budget_count += __atomic_load_n(&worker->over_budget_count, __ATOMIC_RELAXED);
+
+    u64 worker_largest_frame = __atomic_load_n(&worker->largest_frame, __ATOMIC_RELAXED);
+    largest_frame = worker_largest_frame > largest_frame ? worker_largest_frame : largest_frame;
+
+    for(u32 part = 0; part < part_count; part++)
+    {
+      bytes[part] += __atomic_load_n(&worker->frame_bytes[part], __ATOMIC_RELAXED);
+      escapes[part] += __atomic_load_n(&worker->frame_escapes[part], __ATOMIC_RELAXED);
+    }
+  }
+
+  if(frame_count == *reported_frame_count)
+  {
+    return;
+  }
+
+  for(u32 part = 0; part < part_count; part++)
+  {
+    total_bytes += bytes[part];
+    total_escapes += escapes[part];
+  }
+
+  printf("%llu frames, %llu over %u bytes, the largest %llu, %.1f bytes and %.1f escape codes per frame\n",
+         (unsigned long long)frame_count, (unsigned long long)over_budget_count, server.frame_budget,
+         (unsigned long long)largest_frame, (r64)total_bytes / frame_count, (r64)total_escapes / frame_count);
+
+  for(u32 part = 0; part < part_count; part++)
+  {
+    printf("  %-10s %8.1f bytes %6.1f escape codes\n", frame_part_names[part],
+           (r64)bytes[part] / frame_count, (r64)escapes[part] / frame_count);
+  }
+
+  fflush(stdout);
+  *reported_frame_count = frame_count;
+}
+
+internal i32
+open_listen_socket(char *address, i32 port, char *unix_path)
+{
+  i32 fd = -1;
+
+  if(unix_path)
+  {
+    struct sockaddr_un name = {0};
+    name.sun_family = AF_UNIX;
+    if(strlen(unix_path) >= sizeof(name.sun_path))
+    {
+      return -1;
+    }
+
+    strcpy(name.sun_path, unix_path);
+    unlink(unix_path);
+
+    fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd >= 0 && bind(fd, (struct sockaddr *)&name, sizeof(name)))
+    {
+      close(fd);
+      fd = -1;
+    }
+  }
+  else
+  {
+    struct sockaddr_in name = {0};
+    name.sin_family = AF_INET;
+    name.sin_port = htons((u16)port);
+    if(inet_pton(AF_INET, address, &name.sin_addr) != 1)
+    {
+      return -1;
+    }
+
+    fd = socket(AF_INET, SOCK_STREAM, 0);
+    if(fd >= 0)
+    {
+      i32 reuse = 1;
+      setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+      if(bind(fd, (struct sockaddr *)&name, sizeof(name)))
+      {
+        close(fd);
+        fd = -1;
+      }
+    }
+  }
+
+  if(fd >= 0)
+  {
+    if(listen(fd, SOMAXCONN))
+    {
+      close(fd);
+      return -1;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+  }
+
+  return fd;
+}
+
+i32
+main(i32 argc, char **argv)
+{
+  char *address = "127.0.0.1";
+  i32 port = SERVER_DEFAULT_PORT;
+  char *unix_path = 0;
+  i32 thread_count = (i32)sysconf(_SC_NPROCESSORS_ONLN);
+  server.frame_budget = SERVER_DEFAULT_FRAME_BUDGET;
+
+  for(i32 i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--threads") && (i + 1) < argc)
+    {
+      thread_count = atoi(argv[++i]);
+    }
+    else if(!strcmp(argv[i], "--port") && (i + 1) < argc)
+    {
+      port = atoi(argv[++i]);
+    }
+    else if(!strcmp(argv[i], "--address") && (i + 1) < argc)
+    {
+      address = argv[++i];
+    }
+    else if(!strcmp(argv[i], "--unix") && (i + 1) < argc)
+    {
+      unix_path = argv[++i];
+    }
+    else if(!strcmp(argv[i], "--frame-budget") && (i + 1) < argc)
+    {
+      server.frame_budget = (u32)strtoul(argv[++i], 0, 10);
+    }
+    else
+    {
+      printf("Usage: %s [--threads count] [--frame-budget bytes] [--address address] [--port port]\n"
+             "       %s [--threads count] [--frame-budget bytes] --unix path\n", argv[0], argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  // Every session is a descriptor
+  struct rlimit limit;
+  if(!getrlimit(RLIMIT_NOFILE, &limit))
+  {
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+  }
+
+  server.listen_fd = open_listen_socket(address, port, unix_path);
+  if(server.listen_fd < 0)
+  {
+    printf("Could not listen on %s.\n", unix_path ? unix_path : address);
+    return EXIT_FAILURE;
+  }
+
+  server.epoll_fd = epoll_create1(0);
+
+  // Every new session starts out as a copy of this
+  rebirth_ctx_t *new_game = calloc(1, sizeof(rebirth_ctx_t));
+  init_game_data(new_game);
+  pack_game(new_game, &server.new_game);
+  free(new_game);
+
+  thread_count = thread_count < 1 ? 1 : thread_count;
+  thread_count = thread_count > SERVER_MAX_THREADS ? SERVER_MAX_THREADS : thread_count;
+
+  pthread_mutex_init(&server.lock, 0);
+  pthread_cond_init(&server.work_queued, 0);
+  server.worker_count = thread_count;
+  server.workers = calloc(thread_count, sizeof(server_worker_t));
+
+  for(i32 i = 0; i < thread_count; i++)
+  {
+    server_worker_t *worker = &server.workers[i];
+    worker->index = i;
+    worker->random = 0x9E3779B9 * (i + 1);
+    init_slab(&worker->sessions, sizeof(session_t));
+    init_slab(&worker->snapshots, sizeof(session_snapshot_t));
+    pthread_mutex_init(&worker->deque.lock, 0);
+    pthread_create(&worker->thread, 0, run_server_worker, worker);
+  }
+
+  struct epoll_event event = {0};
+  event.events = EPOLLIN;
+  event.data.ptr = 0;
+  epoll_ctl(server.epoll_fd, EPOLL_CTL_ADD, server.listen_fd, &event);
+
+  if(unix_path)
+  {
+    printf("Listening on %s with %d threads\n", unix_path, thread_count);
+  }
+  else
+  {
+    printf("Listening on %s:%d with %d threads\n", address, port, thread_count);
+  }
+
+  printf("Sessions take %zu bytes, %zu more while they can't be won\n",
+         sizeof(session_t), sizeof(session_snapshot_t));
+  fflush(stdout);
+
+  struct timespec last_report;
+  clock_gettime(CLOCK_MONOTONIC, &last_report);
+  u64 reported_size = 0;
+  u32 reported_count = 0;
+  u64 reported_frame_count = 0;
+
+  struct epoll_event events[SERVER_MAX_EVENTS];
+  for(;;)
+  {
+    i32 event_count = epoll_wait(server.epoll_fd, events, SERVER_MAX_EVENTS, SERVER_REPORT_SECONDS * 1000);
+    if(event_count < 0 && errno != EINTR)
+    {
+      break;
+    }
+
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if(now.tv_sec - last_report.tv_sec >= SERVER_REPORT_SECONDS)
+    {
+      last_report = now;
+      print_server_size(&reported_size, &reported_count);
+      print_server_frames(&reported_frame_count);
+    }
+
+    for(i32 i = 0; i < event_count; i++)
+    {
+      session_t *session = (session_t *)events[i].data.ptr;
+      if(!session)
+      {
+        accept_sessions();
+      }
+      else
+      {
+        queue_session(session, events[i].events);
+      }
+    }
+  }
+
+  return EXIT_FAILURE;
+}
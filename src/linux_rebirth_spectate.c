@@ -0,0 +1,454 @@
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#define SPECTATE_MAX_EVENTS 64
+
+// Skip to a keyframe this many frames behind
+#define SPECTATE_MAX_BEHIND 32
+#define SPECTATE_MAX_STUCK (SPECTATE_MAX_BEHIND * 8)
+
+typedef struct spectate_frame_t spectate_frame_t;
+
+// Frame as escape codes, shared by viewers and freed by the last one
+struct spectate_frame_t
+{
+  u32 ref_count;
+  u64 number;
+  spectate_frame_t *next;
+  terminal_output_t output;
+};
+
+typedef struct spectate_viewer_t spectate_viewer_t;
+
+struct spectate_viewer_t
+{
+  i32 fd;
+  u32 index;
+  b32 waiting_to_send;
+
+  // A viewer closed while handling a batch of events is freed after it, the
+  // rest of the batch can still point to it
+  b32 closed;
+  spectate_viewer_t *next_closed;
+
+  // The frame the viewer is at and how much of it has been sent, a keyframe
+  // goes out first and stands in for the frame it was made from
+  spectate_frame_t *frame;
+  spectate_frame_t *keyframe;
+  u32 sent;
+};
+
+typedef struct
+{
+  b32 running;
+  char path[108];
+  pthread_t thread;
+  i32 epoll_fd;
+  i32 listen_fd;
+  i32 wake_fd;
+
+  // Set by the game as it publishes, the latest frame and what it shows
+  pthread_mutex_t lock;
+  spectate_frame_t *latest;
+  u64 latest_number;
+  screen_t shown;
+
+  // Only touched by the spectate thread
+  spectate_frame_t *keyframe;
+  u64 keyframe_number;
+  u32 viewer_count;
+  u32 viewer_capacity;
+  spectate_viewer_t **viewers;
+  spectate_viewer_t *closed;
+} spectate_t;
+
+global spectate_t spectate;
+
+internal spectate_frame_t *
+make_spectate_frame()
+{
+  spectate_frame_t *frame = calloc(1, sizeof(spectate_frame_t));
+  frame->ref_count = 1;
+  return frame;
+}
+
+internal void
+hold_spectate_frame(spectate_frame_t *frame)
+{
+  __atomic_fetch_add(&frame->ref_count, 1, __ATOMIC_RELAXED);
+}
+
+internal void
+let_go_of_spectate_frame(spectate_frame_t *frame)
+{
+  // Freeing a frame lets go of the one after it
+  while(frame && __atomic_sub_fetch(&frame->ref_count, 1, __ATOMIC_ACQ_REL) == 0)
+  {
+    spectate_frame_t *next = __atomic_load_n(&frame->next, __ATOMIC_ACQUIRE);
+    free(frame->output.data);
+    free(frame);
+    frame = next;
+  }
+}
+
+// Called by the game for every frame it shows
+internal void
+publish_spectate_frame(screen_t *screen)
+{
+  if(!spectate.running)
+  {
+    return;
+  }
+
+  spectate_frame_t *frame = make_spectate_frame();
+
+  pthread_mutex_lock(&spectate.lock);
+  write_screen_changes(&frame->output, &spectate.shown, screen, 0);
+  if(!frame->output.count)
+  {
+    pthread_mutex_unlock(&spectate.lock);
+    let_go_of_spectate_frame(frame);
+    return;
+  }
+
+  // One reference for the link from the frame before, one for being latest
+  spectate_frame_t *before = spectate.latest;
+  frame->number = before->number + 1;
+  frame->ref_count = 2;
+  __atomic_store_n(&before->next, frame, __ATOMIC_RELEASE);
+  spectate.latest = frame;
+  __atomic_store_n(&spectate.latest_number, frame->number, __ATOMIC_RELAXED);
+  pthread_mutex_unlock(&spectate.lock);
+
+  let_go_of_spectate_frame(before);
+
+  u64 wake = 1;
+  ssize_t written = write(spectate.wake_fd, &wake, sizeof(wake));
+  (void)written;
+}
+
+// Latest frame and its keyframe
+internal spectate_frame_t *
+get_spectate_keyframe(spectate_frame_t **frame)
+{
+  pthread_mutex_lock(&spectate.lock);
+  *frame = spectate.latest;
+  hold_spectate_frame(*frame);
+
+  if(!spectate.keyframe || spectate.keyframe_number != (*frame)->number)
+  {
+    if(spectate.keyframe)
+    {
+      let_go_of_spectate_frame(spectate.keyframe);
+    }
+
+    spectate.keyframe = make_spectate_frame();
+    spectate.keyframe_number = (*frame)->number;
+
+    screen_t *blank = malloc(sizeof(screen_t));
+    clear_screen(blank);
+
+    char clear[] = "\033[0m\033[2J\033[?25l";
+    push_terminal_output(&spectate.keyframe->output, clear, sizeof(clear) - 1);
+    write_screen_changes(&spectate.keyframe->output, blank, &spectate.shown, 0);
+    free(blank);
+  }
+  pthread_mutex_unlock(&spectate.lock);
+
+  hold_spectate_frame(spectate.keyframe);
+  return spectate.keyframe;
+}
+
+internal void
+close_spectate_viewer(spectate_viewer_t *viewer)
+{
+  epoll_ctl(spectate.epoll_fd, EPOLL_CTL_DEL, viewer->fd, 0);
+  close(viewer->fd);
+
+  let_go_of_spectate_frame(viewer->frame);
+  if(viewer->keyframe)
+  {
+    let_go_of_spectate_frame(viewer->keyframe);
+  }
+
+  spectate.viewers[viewer->index] = spectate.viewers[--spectate.viewer_count];
+  spectate.viewers[viewer->index]->index = viewer->index;
+
+  viewer->closed = true;
+  viewer->next_closed = spectate.closed;
+  spectate.closed = viewer;
+}
+
+internal void
+watch_spectate_viewer(spectate_viewer_t *viewer, b32 waiting_to_send)
+{
+  if(viewer->waiting_to_send != waiting_to_send)
+  {
+    viewer->waiting_to_send = waiting_to_send;
+
+    struct epoll_event event = {0};
+    event.events = EPOLLIN | (waiting_to_send ? EPOLLOUT : 0);
+    event.data.ptr = viewer;
+    epoll_ctl(spectate.epoll_fd, EPOLL_CTL_MOD, viewer->fd, &event);
+  }
+}
+
+// Send unseen frames, returns false if the viewer is gone
+internal b32
+send_spectate_frames(spectate_viewer_t *viewer)
+{
+  for(;;)
+  {
+    spectate_frame_t *sending = viewer->keyframe ? viewer->keyframe : viewer->frame;
+    if(viewer->sent == sending->output.count)
+    {
+      if(viewer->keyframe)
+      {
+        let_go_of_spectate_frame(viewer->keyframe);
+        viewer->keyframe = 0;
+        viewer->sent = viewer->frame->output.count;
+        continue;
+      }
+
+      spectate_frame_t *next = __atomic_load_n(&viewer->frame->next, __ATOMIC_ACQUIRE);
+      if(!next)
+      {
+        watch_spectate_viewer(viewer, false);
+        return true;
+      }
+
+      // Held before letting go, the frame is what holds on to the next one
+      spectate_frame_t *at = viewer->frame;
+      if(__atomic_load_n(&spectate.latest_number, __ATOMIC_RELAXED) - next->number > SPECTATE_MAX_BEHIND)
+      {
+        viewer->keyframe = get_spectate_keyframe(&viewer->frame);
+      }
+      else
+      {
+        hold_spectate_frame(next);
+        viewer->frame = next;
+      }
+
+      let_go_of_spectate_frame(at);
+      viewer->sent = 0;
+
+      continue;
+    }
+
+    ssize_t sent = send(viewer->fd, sending->output.data + viewer->sent,
+                        sending->output.count - viewer->sent, MSG_NOSIGNAL);
+    if(sent > 0)
+    {
+      viewer->sent += (u32)sent;
+    }
+    else if(sent < 0 && errno == EINTR)
+    {
+      continue;
+    }
+    else if(sent < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+    {
+      watch_spectate_viewer(viewer, true);
+      return true;
+    }
+    else
+    {
+      return false;
+    }
+  }
+}
+
+internal void
+accept_spectate_viewers()
+{
+  for(;;)
+  {
+    i32 fd = accept(spectate.listen_fd, 0, 0);
+    if(fd < 0)
+    {
+      if(errno == EINTR || errno == ECONNABORTED)
+      {
+        continue;
+      }
+
+      break;
+    }
+
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+    if(spectate.viewer_count == spectate.viewer_capacity)
+    {
+      spectate.viewer_capacity = spectate.viewer_capacity ? spectate.viewer_capacity * 2 : 64;
+      spectate.viewers = realloc(spectate.viewers, spectate.viewer_capacity * sizeof(spectate_viewer_t *));
+    }
+
+    // Someone joining late starts with the whole frame
+    spectate_viewer_t *viewer = calloc(1, sizeof(spectate_viewer_t));
+    viewer->fd = fd;
+    viewer->index = spectate.viewer_count;
+    viewer->keyframe = get_spectate_keyframe(&viewer->frame);
+    spectate.viewers[spectate.viewer_count++] = viewer;
+
+    struct epoll_event event = {0};
+    event.events = EPOLLIN;
+    event.data.ptr = viewer;
+    epoll_ctl(spectate.epoll_fd, EPOLL_CTL_ADD, fd, &event);
+
+    if(!send_spectate_frames(viewer))
+    {
+      close_spectate_viewer(viewer);
+    }
+  }
+}
+
+internal void *
+run_spectate_thread(void *data)
+{
+  (void)data;
+
+  struct epoll_event events[SPECTATE_MAX_EVENTS];
+  for(;;)
+  {
+    i32 event_count = epoll_wait(spectate.epoll_fd, events, SPECTATE_MAX_EVENTS, -1);
+    if(event_count < 0 && errno != EINTR)
+    {
+      break;
+    }
+
+    for(i32 i = 0; i < event_count; i++)
+    {
+      if(events[i].data.ptr == &spectate.listen_fd)
+      {
+        accept_spectate_viewers();
+      }
+      else if(events[i].data.ptr == &spectate.wake_fd)
+      {
+        u64 wake;
+        ssize_t got = read(spectate.wake_fd, &wake, sizeof(wake));
+        (void)got;
+
+        // A new frame, everyone not still busy with the last one gets it
+        u64 latest_number = __atomic_load_n(&spectate.latest_number, __ATOMIC_RELAXED);
+        for(u32 viewer_i = 0; viewer_i < spectate.viewer_count;)
+        {
+          spectate_viewer_t *viewer = spectate.viewers[viewer_i];
+          if(viewer->waiting_to_send)
+          {
+            if(latest_number - viewer->frame->number > SPECTATE_MAX_STUCK)
+            {
+              close_spectate_viewer(viewer);
+              continue;
+            }
+          }
+          else if(!send_spectate_frames(viewer))
+          {
+            close_spectate_viewer(viewer);
+            continue;
+          }
+
+          viewer_i++;
+        }
+      }
+      else
+      {
+        // Viewers only ever send to hang up, anything they type is dropped
+        spectate_viewer_t *viewer = (spectate_viewer_t *)events[i].data.ptr;
+        if(viewer->closed)
+        {
+          continue;
+        }
+
+        b32 open = true;
+
+        if(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+        {
+          char bytes[256];
+          ssize_t count = recv(viewer->fd, bytes, sizeof(bytes), 0);
+          open = (count > 0 || (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR)));
+        }
+
+        if(open && (events[i].events & EPOLLOUT))
+        {
+          open = send_spectate_frames(viewer);
+        }
+
+        if(!open)
+        {
+          close_spectate_viewer(viewer);
+        }
+      }
+    }
+
+    while(spectate.closed)
+    {
+      spectate_viewer_t *viewer = spectate.closed;
+      spectate.closed = viewer->next_closed;
+      free(viewer);
+    }
+  }
+
+  return 0;
+}
+
+// Returns false if the socket can't be opened
+internal b32
+init_spectating(char *path)
+{
+  struct sockaddr_un name = {0};
+  name.sun_family = AF_UNIX;
+  if(strlen(path) >= sizeof(name.sun_path))
+  {
+    return false;
+  }
+
+  strcpy(name.sun_path, path);
+  unlink(path);
+
+  spectate.listen_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(spectate.listen_fd < 0)
+  {
+    return false;
+  }
+
+  if(bind(spectate.listen_fd, (struct sockaddr *)&name, sizeof(name)) || listen(spectate.listen_fd, SOMAXCONN))
+  {
+    close(spectate.listen_fd);
+    return false;
+  }
+
+  fcntl(spectate.listen_fd, F_SETFL, fcntl(spectate.listen_fd, F_GETFL) | O_NONBLOCK);
+  strcpy(spectate.path, path);
+
+  spectate.epoll_fd = epoll_create1(0);
+  spectate.wake_fd = eventfd(0, EFD_NONBLOCK);
+
+  struct epoll_event event = {0};
+  event.events = EPOLLIN;
+  event.data.ptr = &spectate.listen_fd;
+  epoll_ctl(spectate.epoll_fd, EPOLL_CTL_ADD, spectate.listen_fd, &event);
+  event.data.ptr = &spectate.wake_fd;
+  epoll_ctl(spectate.epoll_fd, EPOLL_CTL_ADD, spectate.wake_fd, &event);
+
+  pthread_mutex_init(&spectate.lock, 0);
+  clear_screen(&spectate.shown);
+  spectate.latest = make_spectate_frame();
+
+  spectate.running = true;
+  pthread_create(&spectate.thread, 0, run_spectate_thread, 0);
+
+  return true;
+}
+
+internal void
+quit_spectating()
+{
+  if(spectate.running)
+  {
+    unlink(spectate.path);
+  }
+}
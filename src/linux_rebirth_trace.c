@@ -0,0 +1,168 @@
+#include <pthread.h>
+#include <time.h>
+
+#define TRACE_MAX_EVENTS (1 << 18)
+#define TRACE_MAX_THREADS 8
+
+// Deepest span nesting
+#define TRACE_MAX_DEPTH 64
+
+typedef struct
+{
+  char *name;
+  u64 time;
+  b32 begin;
+} trace_event_t;
+
+typedef struct
+{
+  u32 thread;
+  u32 count;
+  u32 depth;
+
+  // One bit per open span that was recorded, its end is recorded too
+  u64 recorded;
+  trace_event_t events[TRACE_MAX_EVENTS];
+} trace_buffer_t;
+
+typedef struct
+{
+  char *path;
+  u64 start;
+
+  pthread_mutex_t lock;
+  u32 buffer_count;
+  trace_buffer_t *buffers[TRACE_MAX_THREADS];
+} tracer_t;
+
+global tracer_t tracer = {0, 0, PTHREAD_MUTEX_INITIALIZER, 0, {0}};
+
+// Only traced threads have a buffer
+static __thread trace_buffer_t *trace_buffer;
+
+internal u64
+get_trace_time()
+{
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return ((u64)time.tv_sec * 1000000000) + (u64)time.tv_nsec;
+}
+
+internal void
+begin_trace_span(char *name)
+{
+  trace_buffer_t *buffer = trace_buffer;
+  if(!buffer || buffer->depth == TRACE_MAX_DEPTH)
+  {
+    return;
+  }
+
+  u64 bit = (u64)1 << buffer->depth++;
+  if(buffer->count < TRACE_MAX_EVENTS - TRACE_MAX_DEPTH)
+  {
+    trace_event_t *event = &buffer->events[buffer->count++];
+    event->name = name;
+    event->time = get_trace_time();
+    event->begin = true;
+    buffer->recorded |= bit;
+  }
+  else
+  {
+    buffer->recorded &= ~bit;
+  }
+}
+
+internal void
+end_trace_span()
+{
+  trace_buffer_t *buffer = trace_buffer;
+  if(!buffer || !buffer->depth)
+  {
+    return;
+  }
+
+  u64 bit = (u64)1 << --buffer->depth;
+  if(buffer->recorded & bit)
+  {
+    trace_event_t *event = &buffer->events[buffer->count++];
+    event->name = 0;
+    event->time = get_trace_time();
+    event->begin = false;
+  }
+}
+
+// Trace the calling thread
+internal b32
+trace_this_thread(char *path)
+{
+  pthread_mutex_lock(&tracer.lock);
+
+  b32 result = false;
+  if(tracer.buffer_count < TRACE_MAX_THREADS)
+  {
+    if(!tracer.path)
+    {
+      tracer.path = path;
+      tracer.start = get_trace_time();
+    }
+
+    trace_buffer = calloc(1, sizeof(trace_buffer_t));
+    trace_buffer->thread = tracer.buffer_count + 1;
+    tracer.buffers[tracer.buffer_count++] = trace_buffer;
+    result = true;
+  }
+
+  pthread_mutex_unlock(&tracer.lock);
+  return result;
+}
+
+// Write Chrome trace events, call once traced threads are done
+internal void
+quit_tracing()
+{
+  if(!tracer.path)
+  {
+    return;
+  }
+
+  FILE *file = fopen(tracer.path, "wb");
+  if(file)
+  {
+    fprintf(file, "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n");
+
+    b32 first = true;
+    for(u32 buffer_i = 0; buffer_i < tracer.buffer_count; buffer_i++)
+    {
+      trace_buffer_t *buffer = tracer.buffers[buffer_i];
+      for(u32 i = 0; i < buffer->count; i++)
+      {
+        trace_event_t *event = &buffer->events[i];
+        u64 time = event->time - tracer.start;
+
+        fprintf(file, "%s{\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%llu.%03llu",
+                first ? "" : ",\n", event->begin ? 'B' : 'E', buffer->thread,
+                (unsigned long long)(time / 1000), (unsigned long long)(time % 1000));
+
+        if(event->begin)
+        {
+          fprintf(file, ",\"name\":\"%s\"", event->name);
+        }
+
+        fprintf(file, "}");
+        first = false;
+      }
+    }
+
+    fprintf(file, "\n]}\n");
+    fclose(file);
+  }
+
+  for(u32 i = 0; i < tracer.buffer_count; i++)
+  {
+    free(tracer.buffers[i]);
+  }
+
+  tracer.buffer_count = 0;
+  tracer.path = 0;
+  trace_buffer = 0;
+}
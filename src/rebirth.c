@@ -0,0 +1,3660 @@
+#include "rebirth.h"
+
+global escape_step_t escape_steps[] =
+{
+  {puzzle_first_door_spade_inserted, item_metal_spade_no_handle, {item_none, item_none}, 0, item_none},
+  {puzzle_first_door_cupric_sulfate_added, item_cupric_sulfate, {item_none, item_none}, 0, item_none},
+  {puzzle_first_door_dihydrogen_monoxide_added, item_dihydrogen_monoxide, {item_none, item_none}, 0, item_none},
+  {puzzle_second_door_dihydrogen_monoxide_added, item_dihydrogen_monoxide, {item_tin, item_none}, 0, item_none},
+  {puzzle_second_door_gypsum_added, item_gypsum, {item_tin, item_none}, 0, item_none},
+  {puzzle_second_door_key_imprint_made, item_none, {item_tin, item_none}, 0, item_none},
+  {puzzle_second_door_cupric_ore_powder_added, item_cupric_ore_powder, {item_tin, item_none}, 0, item_none},
+  {puzzle_second_door_tin_ore_powder_added, item_tin_ore_powder, {item_tin, item_none}, 0, item_none},
+  {puzzle_second_door_key_complete, item_none, {item_tin, item_none}, 1, item_none},
+  {puzzle_second_door_key_pried, item_none, {item_tin, item_knife}, 0, item_bronze_key},
+  {puzzle_second_door_key_inserted, item_bronze_key, {item_none, item_none}, 0, item_none}
+};
+
+global escape_recipe_t escape_recipes[] =
+{
+  {item_metal_spade_no_handle, item_metal_spade, 1}
+};
+
+// Default level
+global level_t rebirth_level =
+{
+  {
+    "########################",
+    "#######BBB###.B..#######",
+    "###BB.............xXX###",
+    "###........L..L.....C###",
+    "##~.......TTTT.......|.+",
+    "###i......TTTT.......###",
+    "###.......L........xX###",
+    "###.BB..........i..XX###",
+    "######.BBB.B..##########",
+    "########################"
+  },
+  
+  {
+    {13, 4, item_metal_spade, 0},
+    {12, 5, item_bunsen_burner, 2},
+    {10, 4, item_empty_vial, 0}
+  },
+  
+  {
+    {4, 7, {item_knife, item_none, item_none}},
+    {7, 8, {item_dihydrogen_monoxide, item_dihydrogen_monoxide, item_dihydrogen_monoxide}},
+    {8, 8, {item_cupric_ore_powder, item_none, item_none}},
+    {9, 8, {item_tin_ore_powder, item_none, item_none}},
+    {11, 8, {item_empty_vial, item_none, item_none}},
+    {19, 2, {item_tin, item_none, item_none}},
+    {14, 1, {item_sodium_chloride, item_none, item_none}},
+    {9, 1, {item_gypsum, item_none, item_none}},
+    {8, 1, {item_cupric_sulfate, item_none, item_none}},
+    {7, 1, {item_dihydrogen_monoxide, item_acetic_acid, item_none}},
+    {3, 2, {item_magnet, item_none, item_none}}
+  },
+  
+  3, 6,
+  4
+};
+
+global i32 direction_x[4] = {0, -1, 0, 1};
+global i32 direction_y[4] = {-1, 0, 1, 0};
+
+// Drop the event if the log is full
+internal void
+log_play_event(rebirth_ctx_t *ctx, play_event_e kind, i32 x, i32 y, i32 first_item, i32 second_item, u32 detail)
+{
+  play_log_t *log = ctx->play_log;
+  if(!log)
+  {
+    return;
+  }
+  
+  u32 head = log->head;
+  if(head - __atomic_load_n(&log->tail, __ATOMIC_ACQUIRE) == PLAY_LOG_SIZE)
+  {
+    log->dropped++;
+    return;
+  }
+  
+  play_event_t *event = &log->events[head & (PLAY_LOG_SIZE - 1)];
+  event->turn = (u16)ctx->player.turn;
+  event->kind = (u8)kind;
+  event->key = (u8)ctx->player.input;
+  event->x = (u8)x;
+  event->y = (u8)y;
+  event->first_item = (u8)first_item;
+  event->second_item = (u8)second_item;
+  event->puzzle = ctx->game.puzzle;
+  event->unused = 0;
+  event->detail = detail;
+  
+  __atomic_store_n(&log->head, head + 1, __ATOMIC_RELEASE);
+}
+
+internal inline b32
+is_puzzle_flag_set(rebirth_ctx_t *ctx, puzzle_flag_e flag)
+{
+  return (ctx->game.puzzle >> flag) & 1;
+}
+
+internal inline void
+set_puzzle_flag(rebirth_ctx_t *ctx, puzzle_flag_e flag)
+{
+  ctx->game.puzzle |= (u16)(1 << flag);
+  log_play_event(ctx, play_puzzle, ctx->player.x, ctx->player.y, item_none, item_none, flag | 0x80);
+}
+
+internal inline void
+unset_puzzle_flag(rebirth_ctx_t *ctx, puzzle_flag_e flag)
+{
+  ctx->game.puzzle &= (u16)~(1 << flag);
+  log_play_event(ctx, play_puzzle, ctx->player.x, ctx->player.y, item_none, item_none, flag);
+}
+
+internal inline b32
+is_searched(rebirth_ctx_t *ctx, i32 i)
+{
+  return (ctx->searched >> i) & 1;
+}
+
+internal inline u8
+get_room_tile(level_t *level, room_t *room, i32 x, i32 y)
+{
+  u8 result = level->room[y][x];
+  
+  i32 tile = (y * ROOM_WIDTH) + x;
+  if(room->changed[tile / 32] & ((u32)1 << (tile % 32)))
+  {
+    for(u32 i = 0; i < room->change_count; i++)
+    {
+      if(room->changes[i].tile == tile)
+      {
+        result = room->changes[i].glyph;
+        break;
+      }
+    }
+  }
+  
+  return result;
+}
+
+internal inline u8
+get_tile(rebirth_ctx_t *ctx, i32 x, i32 y)
+{
+  return get_room_tile(ctx->level, &ctx->room, x, y);
+}
+
+internal inline b32
+is_opaque(u8 glyph)
+{
+  b32 result = (glyph == glyph_stone ||
+                glyph == glyph_bookshelf ||
+                glyph == glyph_crate ||
+                glyph == glyph_stone_door ||
+                glyph == glyph_wooden_door ||
+                glyph == glyph_chain);
+  
+  return result;
+}
+
+internal inline b32
+is_burnable(u8 glyph)
+{
+  b32 result = (glyph == glyph_bookshelf ||
+                glyph == glyph_crate ||
+                glyph == glyph_small_crate ||
+                glyph == glyph_table ||
+                glyph == glyph_chair ||
+                glyph == glyph_open_chest);
+  
+  return result;
+}
+
+internal inline b32
+is_walkable(u8 glyph)
+{
+  b32 result = (glyph == glyph_floor ||
+                glyph == glyph_stone_door_open ||
+                glyph == glyph_wooden_door_open);
+  
+  return result;
+}
+
+// Recast the sources that reach the tile
+internal void
+invalidate_light_at(rebirth_ctx_t *ctx, i32 tile)
+{
+  for(u32 i = 0; i < ctx->light.source_count; i++)
+  {
+    light_source_t *source = &ctx->light.sources[i];
+    if(source->lit[tile / 32] & ((u32)1 << (tile % 32)))
+    {
+      source->stale = true;
+    }
+  }
+}
+
+internal void
+invalidate_light(rebirth_ctx_t *ctx)
+{
+  for(u32 i = 0; i < ctx->light.source_count; i++)
+  {
+    ctx->light.sources[i].stale = true;
+  }
+}
+
+internal inline void
+set_room_bits(room_t *room, i32 x, i32 y, u8 glyph)
+{
+  u32 bit = (u32)1 << x;
+  room->traversable[y] = is_walkable(glyph) ? (room->traversable[y] | bit) : (room->traversable[y] & ~bit);
+  room->opaque[y] = is_opaque(glyph) ? (room->opaque[y] | bit) : (room->opaque[y] & ~bit);
+  room->burnable[y] = is_burnable(glyph) ? (room->burnable[y] | bit) : (room->burnable[y] & ~bit);
+}
+
+internal void
+set_tile(rebirth_ctx_t *ctx, i32 x, i32 y, u8 glyph)
+{
+  room_t *room = &ctx->room;
+  i32 tile = (y * ROOM_WIDTH) + x;
+  
+  u32 at = 0;
+  while(at < room->change_count && room->changes[at].tile < tile)
+  {
+    at++;
+  }
+  
+  b32 changed = (at < room->change_count && room->changes[at].tile == tile);
+  u8 old_glyph = changed ? room->changes[at].glyph : ctx->level->room[y][x];
+  if(is_opaque(old_glyph) != is_opaque(glyph))
+  {
+    invalidate_light_at(ctx, tile);
+  }
+  
+  // Any way could go through the tile, every travel field is walked again
+  if(is_walkable(old_glyph) != is_walkable(glyph))
+  {
+    ctx->travel.field_count = 0;
+  }
+  
+  set_room_bits(room, x, y, glyph);
+  
+  if(glyph == ctx->level->room[y][x])
+  {
+    // Back to what the level has, the change goes
+    if(changed)
+    {
+      room->change_count--;
+      memmove(&room->changes[at], &room->changes[at + 1], (room->change_count - at) * sizeof(tile_change_t));
+      memset(&room->changes[room->change_count], 0, sizeof(tile_change_t));
+      room->changed[tile / 32] &= ~((u32)1 << (tile % 32));
+    }
+  }
+  else if(changed)
+  {
+    room->changes[at].glyph = glyph;
+  }
+  else
+  {
+    check_index((i32)room->change_count, ROOM_CHANGE_COUNT);
+    memmove(&room->changes[at + 1], &room->changes[at], (room->change_count - at) * sizeof(tile_change_t));
+    room->changes[at].tile = (u8)tile;
+    room->changes[at].glyph = glyph;
+    room->change_count++;
+    room->changed[tile / 32] |= (u32)1 << (tile % 32);
+  }
+}
+
+// Octant row and column to room
+global i32 light_octants[8][4] =
+{
+  {1, 0, 0, 1},
+  {0, 1, 1, 0},
+  {0, -1, 1, 0},
+  {-1, 0, 0, 1},
+  {-1, 0, 0, -1},
+  {0, -1, -1, 0},
+  {0, 1, -1, 0},
+  {1, 0, 0, -1}
+};
+
+// Recursive shadowcasting
+internal void
+cast_light(rebirth_ctx_t *ctx, light_source_t *source, i32 *octant, i32 row, r32 start, r32 end)
+{
+  if(start < end)
+  {
+    return;
+  }
+  
+  r32 next_start = start;
+  for(i32 distance = row; distance <= source->radius; distance++)
+  {
+    b32 blocked = false;
+    for(i32 column = -distance; column <= 0; column++)
+    {
+      r32 left_slope = (column - 0.5f) / (-distance + 0.5f);
+      r32 right_slope = (column + 0.5f) / (-distance - 0.5f);
+      if(start < right_slope)
+      {
+        continue;
+      }
+      else if(end > left_slope)
+      {
+        break;
+      }
+      
+      i32 x = source->x + (column * octant[0]) + (-distance * octant[1]);
+      i32 y = source->y + (column * octant[2]) + (-distance * octant[3]);
+      
+      b32 opaque = true;
+      if(x >= 0 && x < ROOM_WIDTH && y >= 0 && y < ROOM_HEIGHT)
+      {
+        if((column * column) + (distance * distance) <= (source->radius * source->radius) + source->radius)
+        {
+          i32 tile = (y * ROOM_WIDTH) + x;
+          source->lit[tile / 32] |= (u32)1 << (tile % 32);
+        }
+        
+        opaque = (ctx->room.opaque[y] >> x) & 1;
+      }
+      
+      if(blocked)
+      {
+        if(opaque)
+        {
+          next_start = right_slope;
+        }
+        else
+        {
+          blocked = false;
+          start = next_start;
+        }
+      }
+      else if(opaque && distance < source->radius)
+      {
+        blocked = true;
+        cast_light(ctx, source, octant, distance + 1, start, left_slope);
+        next_start = right_slope;
+      }
+    }
+    
+    if(blocked)
+    {
+      break;
+    }
+  }
+}
+
+internal void
+cast_source_light(rebirth_ctx_t *ctx, light_source_t *source)
+{
+  memset(source->lit, 0, sizeof(source->lit));
+  source->stale = false;
+  
+  i32 tile = (source->y * ROOM_WIDTH) + source->x;
+  source->lit[tile / 32] |= (u32)1 << (tile % 32);
+  
+  for(u32 i = 0; i < array_count(light_octants); i++)
+  {
+    cast_light(ctx, source, light_octants[i], 1, 1.0f, 0.0f);
+  }
+}
+
+internal i32
+get_carried_light_radius(rebirth_ctx_t *ctx)
+{
+  i32 result = PLAYER_LIGHT_RADIUS;
+  for(i32 i = 0; i < ctx->player.inventory_item_count; i++)
+  {
+    item_t *item = &ctx->player.inventory[i];
+    if(item->type == item_bunsen_burner && item->use_count < item->max_use_count)
+    {
+      result = CARRIED_LIGHT_RADIUS;
+    }
+  }
+  
+  return result;
+}
+
+// Recast the sources that changed
+internal void
+update_light(rebirth_ctx_t *ctx)
+{
+  light_t *light = &ctx->light;
+  if(!light->source_count)
+  {
+    // The torches never move, they're found in the level once
+    light->source_count = 2;
+    light->sources[0].stale = true;
+    light->sources[1].stale = true;
+    
+    for(i32 y = 0; y < ROOM_HEIGHT; y++)
+    {
+      for(i32 x = 0; x < ROOM_WIDTH; x++)
+      {
+        if(ctx->level->room[y][x] == glyph_torch && light->source_count < LIGHT_SOURCE_COUNT)
+        {
+          light_source_t *torch = &light->sources[light->source_count++];
+          torch->x = x;
+          torch->y = y;
+          torch->radius = TORCH_LIGHT_RADIUS;
+          torch->stale = true;
+        }
+      }
+    }
+  }
+  
+  i32 radii[2] = {SIGHT_RADIUS, get_carried_light_radius(ctx)};
+  for(u32 i = 0; i < array_count(radii); i++)
+  {
+    light_source_t *source = &light->sources[i];
+    if(source->x != ctx->player.x ||
+       source->y != ctx->player.y ||
+       source->radius != radii[i])
+    {
+      source->x = ctx->player.x;
+      source->y = ctx->player.y;
+      source->radius = radii[i];
+      source->stale = true;
+    }
+  }
+  
+  for(u32 i = 0; i < light->source_count; i++)
+  {
+    if(light->sources[i].stale)
+    {
+      cast_source_light(ctx, &light->sources[i]);
+    }
+  }
+  
+  for(u32 word = 0; word < ROOM_TILE_WORDS; word++)
+  {
+    u32 lit = light->sources[1].lit[word];
+    if(!ctx->game.dark)
+    {
+      for(u32 i = 2; i < light->source_count; i++)
+      {
+        lit |= light->sources[i].lit[word];
+      }
+    }
+    
+    light->visible[word] = light->sources[0].lit[word] & lit;
+    ctx->seen[word] |= light->visible[word];
+  }
+}
+
+internal inline b32
+is_visible(rebirth_ctx_t *ctx, i32 x, i32 y)
+{
+  i32 tile = (y * ROOM_WIDTH) + x;
+  return (ctx->light.visible[tile / 32] >> (tile % 32)) & 1;
+}
+
+internal inline b32
+is_seen(rebirth_ctx_t *ctx, i32 x, i32 y)
+{
+  i32 tile = (y * ROOM_WIDTH) + x;
+  return (ctx->seen[tile / 32] >> (tile % 32)) & 1;
+}
+
+internal i32
+get_inventory_position_for_item_type(rebirth_ctx_t *ctx, item_e type)
+{
+  i32 result = -1;
+
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->player.inventory[i].type == type)
+    {
+      result = i;
+      break;
+    }
+  }
+
+  return result;
+}
+
+internal int
+is_item_pos(rebirth_ctx_t *ctx, i32 x, i32 y)
+{
+  i32 result = 0;
+  
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->items[i].active && !ctx->items[i].in_inventory)
+    {
+      if(x == ctx->items[i].x && y == ctx->items[i].y)
+      {
+        result = 1;
+        break;
+      }
+    }
+  }
+  
+  return result;
+}
+
+internal char
+get_item_glyph_for_item_type(i32 type)
+{
+  char result = 0;
+  switch(type)
+  {
+    case item_metal_spade: result = glyph_metal_spade; break;
+    case item_metal_spade_no_handle: result = glyph_metal_spade_no_handle; break;
+    case item_knife: result = glyph_knife; break;
+    case item_empty_vial: result = glyph_vial; break;
+    case item_dihydrogen_monoxide: result = glyph_vial; break;
+    case item_cupric_ore_powder: result = glyph_vial; break;
+    case item_tin_ore_powder: result = glyph_vial; break;
+    case item_tin: result = glyph_tin; break;
+    case item_sodium_chloride: result = glyph_vial; break;
+    case item_gypsum: result = glyph_vial; break;
+    case item_cupric_sulfate: result = glyph_vial; break;
+    case item_acetic_acid: result = glyph_vial; break;
+    case item_magnet: result = glyph_magnet; break;
+    case item_bunsen_burner: result = glyph_bunsen_burner; break;
+    case item_bronze_key: result = glyph_bronze_key; break;
+  }
+  
+  return result;
+}
+
+internal i32
+get_next_free_item_id(rebirth_ctx_t *ctx)
+{
+  i32 free_id = 0;
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->items[i].id > free_id)
+    {
+      free_id = ctx->items[i].id;
+    }
+  }
+  
+  if(free_id == 0)
+  {
+    free_id = 1;
+  }
+  else
+  {
+    free_id++;
+  }
+  
+  return free_id;
+}
+
+internal void
+get_item_name_for_item_type(char *storage, i32 type)
+{
+  switch(type)
+  {
+    case item_metal_spade: strcpy(storage, "Metal Spade"); break;
+    case item_metal_spade_no_handle: strcpy(storage, "Metal Spade (No Handle)"); break;
+    case item_knife: strcpy(storage, "Knife"); break;
+    case item_empty_vial: strcpy(storage, "Empty Vial"); break;
+    case item_dihydrogen_monoxide: strcpy(storage, "Dihydrogen Monoxide"); break;
+    case item_cupric_ore_powder: strcpy(storage, "Cupric Ore Powder"); break;
+    case item_tin_ore_powder: strcpy(storage, "Tin Ore Powder"); break;
+    case item_tin: strcpy(storage, "Tin"); break;
+    case item_sodium_chloride: strcpy(storage, "Sodium Chloride"); break;
+    case item_gypsum: strcpy(storage, "Gypsum"); break;
+    case item_cupric_sulfate: strcpy(storage, "Cupric Sulfate"); break;
+    case item_acetic_acid: strcpy(storage, "Acetic Acid"); break;
+    case item_magnet: strcpy(storage, "Magnet"); break;
+    case item_bunsen_burner: strcpy(storage, "Bunsen Burner"); break;
+    case item_bronze_key: strcpy(storage, "Bronze Key"); break;
+  }
+}
+
+internal char *
+get_glyph_name(u8 glyph)
+{
+  switch(glyph)
+  {
+    case glyph_bookshelf: return "bookshelf";
+    case glyph_crate: return "crate";
+    case glyph_small_crate: return "small crate";
+    case glyph_stone_door: return "stone door";
+    case glyph_stone_door_open: return "open stone door";
+    case glyph_wooden_door: return "wooden door";
+    case glyph_wooden_door_open: return "open wooden door";
+    case glyph_open_chest: return "chest";
+    case glyph_table: return "table";
+    case glyph_chair: return "chair";
+    case glyph_torch: return "torch";
+    case glyph_chain: return "chain";
+    case glyph_ash: return "ash";
+  }
+
+  return "floor";
+}
+
+internal inline i32
+equal_pos(i32 ax, i32 ay, i32 bx, i32 by)
+{
+  if(ax == bx && ay == by)
+  {
+    return 1;
+  }
+  
+  return 0;
+}
+
+internal i32
+add_item(rebirth_ctx_t *ctx, i32 x, i32 y, item_e type, i32 max_use_count)
+{
+  i32 result = -1;
+  
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(!ctx->items[i].active && !ctx->items[i].in_inventory)
+    {
+      ctx->items[i].active = true;
+      ctx->items[i].in_inventory = false;
+      ctx->items[i].type = type;
+      get_item_name_for_item_type(ctx->items[i].name, type);
+      ctx->items[i].id = get_next_free_item_id(ctx);
+      ctx->items[i].x = x;
+      ctx->items[i].y = y;
+      ctx->items[i].use_count = 0;
+      ctx->items[i].max_use_count = max_use_count;
+      ctx->items[i].glyph = get_item_glyph_for_item_type(type);
+      result = ctx->items[i].id;
+      break;
+    }
+  }
+  
+  return result;
+}
+
+internal i32
+get_free_item_count(rebirth_ctx_t *ctx)
+{
+  i32 result = 0;
+  
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(!ctx->items[i].active && !ctx->items[i].in_inventory)
+    {
+      result++;
+    }
+  }
+  
+  return result;
+}
+
+internal void
+init_game_data(rebirth_ctx_t *ctx)
+{
+  trace_begin("init_game_data");
+  
+  if(!ctx->level)
+  {
+    ctx->level = &rebirth_level;
+  }
+  
+  // Game
+  memset(&ctx->game, 0, sizeof(game_t));
+  ctx->game.menu_option_selected = 1;
+  ctx->game.menu_option_count = 3;
+  
+  // Player
+  memset(&ctx->player, 0, sizeof(player_t));
+  ctx->player.x = ctx->level->start_x;
+  ctx->player.y = ctx->level->start_y;
+  
+  // Room
+  memset(&ctx->room, 0, sizeof(room_t));
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+    for(i32 x = 0; x < ROOM_WIDTH; x++)
+    {
+      set_room_bits(&ctx->room, x, y, ctx->level->room[y][x]);
+    }
+  }
+  
+  memset(&ctx->seen, 0, sizeof(ctx->seen));
+  memset(&ctx->light, 0, sizeof(light_t));
+  ctx->travel.field_count = 0;
+  
+  // Items
+  memset(&ctx->items, 0, sizeof(ctx->items));
+  for(u32 i = 0; i < LEVEL_ITEM_COUNT; i++)
+  {
+    level_item_t *item = &ctx->level->items[i];
+    add_item(ctx, item->x, item->y, item->type, item->max_use_count);
+  }
+  
+  // Searchables
+  ctx->searched = 0;
+  
+  trace_end();
+}
+
+internal i32
+is_valid_input(i32 key)
+{
+  if(key == 'w' ||
+     key == 'a' ||
+     key == 's' ||
+     key == 'd' ||
+     key == 'b' ||
+     key == 'c' ||
+     key == 'p' ||
+     key == 'o' ||
+     key == 'i' ||
+     key == 'u' ||
+     key == 'y' ||
+     key == 't' ||
+     key == '.' ||
+     key == 'q')
+  {
+    return 1;
+  }
+  
+  return 0;
+}
+
+internal i32
+get_item_type_for_inventory_position(rebirth_ctx_t *ctx, i32 i)
+{
+  check_index(i - 1, ITEM_COUNT);
+  return ctx->player.inventory[i - 1].type;
+}
+
+internal i32
+is_traversable(rebirth_ctx_t *ctx, i32 x, i32 y)
+{
+#if REBIRTH_SLOW
+  i32 result = 1;
+#else
+  i32 result = 0;
+#endif
+  if(x < 0 || x >= ROOM_WIDTH || y < 0 || y >= ROOM_HEIGHT)
+  {
+    result = 0;
+  }
+  else if((ctx->room.traversable[y] >> x) & 1)
+  {
+    result = 1;
+  }
+  
+  return result;
+}
+
+// One breadth first step, a row at a time
+internal b32
+step_room_flood(rebirth_ctx_t *ctx, u32 *frontier, u32 *reached, u32 stepped[4][ROOM_HEIGHT])
+{
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+#if REBIRTH_SLOW
+    (void)ctx;
+    u32 open = ROOM_ROW_MASK & ~reached[y];
+#else
+    u32 open = ctx->room.traversable[y] & ~reached[y];
+#endif
+    
+    stepped[0][y] = (y + 1 < ROOM_HEIGHT) ? (frontier[y + 1] & open) : 0;
+    open &= ~stepped[0][y];
+    stepped[1][y] = (frontier[y] >> 1) & open;
+    open &= ~stepped[1][y];
+    stepped[2][y] = (y > 0) ? (frontier[y - 1] & open) : 0;
+    open &= ~stepped[2][y];
+    stepped[3][y] = (frontier[y] << 1) & open;
+  }
+  
+  u32 any = 0;
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+    frontier[y] = stepped[0][y] | stepped[1][y] | stepped[2][y] | stepped[3][y];
+    reached[y] |= frontier[y];
+    any |= frontier[y];
+  }
+  
+  return any != 0;
+}
+
+internal void
+get_item_rows(rebirth_ctx_t *ctx, u32 *rows)
+{
+  memset(rows, 0, ROOM_HEIGHT * sizeof(u32));
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->items[i].active && !ctx->items[i].in_inventory)
+    {
+      rows[ctx->items[i].y] |= (u32)1 << ctx->items[i].x;
+    }
+  }
+}
+
+// Every searchable
+shared void
+get_searchable_rows(rebirth_ctx_t *ctx, u32 *rows)
+{
+  memset(rows, 0, ROOM_HEIGHT * sizeof(u32));
+  for(i32 i = 0; i < SEARCHABLE_COUNT; i++)
+  {
+    searchable_t *searchable = &ctx->level->searchables[i];
+    rows[searchable->y] |= (u32)1 << searchable->x;
+  }
+}
+
+internal item_e
+get_item_type_for_pos(rebirth_ctx_t *ctx, i32 x, i32 y)
+{
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(equal_pos(x, y, ctx->items[i].x, ctx->items[i].y))
+    {
+      return ctx->items[i].type;
+    }
+  }
+  
+  return item_none;
+}
+
+internal i32
+get_item_pos_for_id(rebirth_ctx_t *ctx, i32 id)
+{
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->items[i].id == id)
+    {
+      return i;
+    }
+  }
+  
+  return -1;
+}
+
+// Quiet builds skip formatting messages
+internal void
+push_message(rebirth_ctx_t *ctx, char *msg, ...)
+{
+#if !REBIRTH_QUIET
+  va_list arg_list;
+  va_start(arg_list, msg);
+  vsnprintf(ctx->game.message, sizeof(ctx->game.message), msg, arg_list);
+  va_end(arg_list);
+#else
+  (void)msg;
+#endif
+  
+  // The id of a message is the hash of its format, the same whatever the
+  // names filled into it
+  if(ctx->play_log)
+  {
+    u32 id = 2166136261;
+    for(char *at = msg; *at; at++)
+    {
+      id = (id ^ (u8)*at) * 16777619;
+    }
+    
+    log_play_event(ctx, play_message, ctx->player.x, ctx->player.y, item_none, item_none, id);
+  }
+}
+
+internal void
+remove_inventory_item(rebirth_ctx_t *ctx, i32 i)
+{
+  check_index(i - 1, ITEM_COUNT);
+  i32 id_to_remove = ctx->player.inventory[i - 1].id;
+  
+  // Remove item from game
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->items[i].id == id_to_remove)
+    {
+      memset(&ctx->items[i], 0, sizeof(item_t));
+      break;
+    }
+  }
+  
+  // Reorder game data
+  for(i32 i = 1; i < ITEM_COUNT; i++)
+  {
+    if(ctx->items[i].active || ctx->items[i].in_inventory)
+    {
+      if(!ctx->items[i - 1].active && !ctx->items[i - 1].in_inventory)
+      {
+        ctx->items[i - 1] = ctx->items[i];
+        memset(&ctx->items[i], 0, sizeof(item_t));
+      }
+    }
+  }
+  
+  // Remove item from inventory
+  memset(&ctx->player.inventory[i - 1], 0, sizeof(item_t));
+  
+  // Reorder inventory data
+  for(i32 i = 1; i < ITEM_COUNT; i++)
+  {
+    if(ctx->player.inventory[i].in_inventory)
+    {
+      if(!ctx->player.inventory[i - 1].in_inventory)
+      {
+        ctx->player.inventory[i - 1] = ctx->player.inventory[i];
+        memset(&ctx->player.inventory[i], 0, sizeof(item_t));
+      }
+    }
+  }
+  
+  // Adjust highlighter
+  if((ctx->player.inventory_item_selected - 1) >= 1)
+  {
+    ctx->player.inventory_item_selected--;
+  }
+}
+
+internal void
+reset_inventory_selections(rebirth_ctx_t *ctx)
+{
+  ctx->player.inventory_first_combination_item_num = 0;
+  ctx->player.inventory_second_combination_item_num = 0;
+  ctx->player.inventory_first_combination_item = item_none;
+  ctx->player.inventory_second_combination_item = item_none;
+  ctx->player.inventory_first_combination_item = item_none;
+  ctx->player.inventory_second_combination_item = item_none;
+}
+
+internal void
+drop_inventory_item(rebirth_ctx_t *ctx, i32 x, i32 y, i32 selected)
+{
+  check_index(selected - 1, ITEM_COUNT);
+  i32 id_to_enable = ctx->player.inventory[selected - 1].id;
+  
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->items[i].id == id_to_enable)
+    {
+      ctx->items[i].active = true;
+      ctx->items[i].in_inventory = false;
+      ctx->items[i].x = x;
+      ctx->items[i].y = y;
+      ctx->items[i].use_count = ctx->player.inventory[selected - 1].use_count;
+    }
+  }
+  
+  ctx->player.inventory[selected - 1].active = false;
+  ctx->player.inventory[selected - 1].in_inventory = false;
+  ctx->player.inventory[selected - 1].type = item_none;
+  memset(&ctx->player.inventory[selected - 1].name, 0, GENERAL_LENGTH - 1);
+  ctx->player.inventory[selected - 1].id = 0;
+  ctx->player.inventory[selected - 1].x = 0;
+  ctx->player.inventory[selected - 1].y = 0;
+  ctx->player.inventory[selected - 1].glyph = glyph_blank;
+  
+  for(i32 i = 1; i < ITEM_COUNT; i++)
+  {
+    if(ctx->player.inventory[i].in_inventory)
+    {
+      if(!ctx->player.inventory[i - 1].in_inventory)
+      {
+        ctx->player.inventory[i - 1] = ctx->player.inventory[i];
+        
+        ctx->player.inventory[i].active = false;
+        ctx->player.inventory[i].in_inventory = false;
+        ctx->player.inventory[i].type = item_none;
+        memset(&ctx->player.inventory[i].name, 0, GENERAL_LENGTH - 1);
+        ctx->player.inventory[i].id = 0;
+        ctx->player.inventory[i].x = 0;
+        ctx->player.inventory[i].y = 0;
+        ctx->player.inventory[i].glyph = glyph_blank;
+      }
+    }
+  }
+  
+  if((ctx->player.inventory_item_selected - 1) >= 1)
+  {
+    ctx->player.inventory_item_selected--;
+  }
+  
+  // Slots moved up, forget the combine pick
+  reset_inventory_selections(ctx);
+}
+
+internal void
+add_inventory_item(rebirth_ctx_t *ctx, item_t item)
+{
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(!ctx->player.inventory[i].in_inventory)
+    {
+      ctx->player.inventory[i] = item;
+      ctx->player.inventory[i].active = false;
+      ctx->player.inventory[i].in_inventory = true;
+      return;
+    }
+  }
+}
+
+// Returns false if there's no free item for it
+internal b32
+add_new_inventory_item(rebirth_ctx_t *ctx, item_e type)
+{
+  b32 result = false;
+  
+  i32 i = get_item_pos_for_id(ctx, add_item(ctx, 0, 0, type, 0));
+  if(i >= 0)
+  {
+    ctx->items[i].active = false;
+    ctx->items[i].in_inventory = true;
+    add_inventory_item(ctx, ctx->items[i]);
+    result = true;
+  }
+  
+  return result;
+}
+
+internal void
+update_inventory_item_count(rebirth_ctx_t *ctx)
+{
+  i32 count = 0;
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->player.inventory[i].in_inventory)
+    {
+      count++;
+    }
+  }
+  
+  ctx->player.inventory_item_count = count;
+  if(!ctx->player.inventory_item_count)
+  {
+    ctx->player.inventory_enabled = false;
+    ctx->player.inventory_item_selected = 0;
+    reset_inventory_selections(ctx);
+  }
+}
+
+internal i32
+get_max_use_count_for_item_type(i32 type)
+{
+  i32 result = 0;
+  switch(type)
+  {
+    case item_bunsen_burner: result = 2; break;
+  }
+
+  return result;
+}
+
+internal void
+open_first_door(rebirth_ctx_t *ctx)
+{
+  set_tile(ctx, STONE_DOOR_X - 1, ctx->level->exit_y, glyph_stone_door_open);
+  set_tile(ctx, STONE_DOOR_X, ctx->level->exit_y, glyph_floor);
+
+  set_puzzle_flag(ctx, puzzle_first_door_open);
+}
+
+internal void
+open_second_door(rebirth_ctx_t *ctx)
+{
+  set_tile(ctx, WOODEN_DOOR_X, ctx->level->exit_y, glyph_wooden_door_open);
+
+  set_puzzle_flag(ctx, puzzle_second_door_open);
+}
+
+// Pack only the due turn
+internal inline u8 *
+get_event_slot(rebirth_ctx_t *ctx, u8 due_turn)
+{
+  game_t *game = &ctx->game;
+  
+  u8 *result = &game->event_wheel[0][due_turn % EVENT_WHEEL_SLOTS];
+  if((due_turn / EVENT_WHEEL_SLOTS) != (game->event_turn / EVENT_WHEEL_SLOTS))
+  {
+    result = &game->event_wheel[1][(due_turn / EVENT_WHEEL_SLOTS) % EVENT_WHEEL_SLOTS];
+  }
+  
+  return result;
+}
+
+internal void
+cancel_event(rebirth_ctx_t *ctx, game_event_e kind)
+{
+  scheduled_event_t *event = &ctx->game.events[kind];
+  if(event->pending)
+  {
+    *get_event_slot(ctx, event->due_turn) &= (u8)~(1 << kind);
+    event->pending = false;
+    event->due_turn = 0;
+  }
+}
+
+// Rescheduling moves the event
+internal void
+schedule_event(rebirth_ctx_t *ctx, game_event_e kind, i32 turns)
+{
+  check_index(turns - 1, EVENT_MAX_TURNS);
+  cancel_event(ctx, kind);
+  
+  scheduled_event_t *event = &ctx->game.events[kind];
+  event->pending = true;
+  event->due_turn = (u8)(ctx->game.event_turn + turns);
+  *get_event_slot(ctx, event->due_turn) |= (u8)(1 << kind);
+}
+
+internal void
+start_blackout(rebirth_ctx_t *ctx)
+{
+  ctx->game.dark = true;
+  schedule_event(ctx, event_blackout_end, 1);
+}
+
+internal void
+end_blackout(rebirth_ctx_t *ctx)
+{
+  ctx->game.dark = false;
+}
+
+internal inline b32
+is_burning(rebirth_ctx_t *ctx, i32 x, i32 y)
+{
+  u32 (*fire)[ROOM_HEIGHT] = ctx->game.fire[ctx->game.fire_front];
+  b32 result = ((fire[0][y] | fire[1][y]) >> x) & 1;
+  return result;
+}
+
+internal void
+get_burning_rows(rebirth_ctx_t *ctx, u32 *rows)
+{
+  u32 (*fire)[ROOM_HEIGHT] = ctx->game.fire[ctx->game.fire_front];
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+    rows[y] = fire[0][y] | fire[1][y];
+  }
+}
+
+internal inline u32
+get_row_neighbours(u32 *rows, i32 y)
+{
+  u32 result = ((rows[y] << 1) | (rows[y] >> 1)) & ROOM_ROW_MASK;
+  result |= (y > 0) ? rows[y - 1] : 0;
+  result |= (y + 1 < ROOM_HEIGHT) ? rows[y + 1] : 0;
+  return result;
+}
+
+// Burn until the wood runs out
+internal void
+get_fire_footprint(rebirth_ctx_t *ctx, u32 *rows)
+{
+  get_burning_rows(ctx, rows);
+  
+  u32 item_rows[ROOM_HEIGHT];
+  get_item_rows(ctx, item_rows);
+  
+  for(b32 grew = true; grew;)
+  {
+    grew = false;
+    for(i32 y = 0; y < ROOM_HEIGHT; y++)
+    {
+      u32 caught = get_row_neighbours(rows, y) & ctx->room.burnable[y] & ~item_rows[y] & ~rows[y];
+      rows[y] |= caught;
+      grew |= (caught != 0);
+    }
+  }
+}
+
+// Burning with three turns left
+internal void
+ignite_tile(rebirth_ctx_t *ctx, i32 x, i32 y)
+{
+  u32 (*fire)[ROOM_HEIGHT] = ctx->game.fire[ctx->game.fire_front];
+  fire[0][y] |= (u32)1 << x;
+  fire[1][y] |= (u32)1 << x;
+  
+  if(!ctx->game.events[event_fire].pending)
+  {
+    schedule_event(ctx, event_fire, 1);
+  }
+}
+
+// Spread fire and burn down, front buffer into back
+internal void
+spread_fire(rebirth_ctx_t *ctx)
+{
+  game_t *game = &ctx->game;
+  u32 (*front)[ROOM_HEIGHT] = game->fire[game->fire_front];
+  u32 (*back)[ROOM_HEIGHT] = game->fire[!game->fire_front];
+  
+  u32 burning[ROOM_HEIGHT];
+  get_burning_rows(ctx, burning);
+  
+  // Like lighting it with the burner, wood with something on it doesn't catch
+  u32 item_rows[ROOM_HEIGHT];
+  get_item_rows(ctx, item_rows);
+  
+  u32 burned_out[ROOM_HEIGHT];
+  u32 still_burning = 0;
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+    u32 caught = get_row_neighbours(burning, y) & ctx->room.burnable[y] & ~item_rows[y] & ~burning[y];
+    
+    // Three goes to two, two to one and one to zero
+    back[0][y] = (front[1][y] & ~front[0][y]) | caught;
+    back[1][y] = (front[1][y] & front[0][y]) | caught;
+    
+    burned_out[y] = burning[y] & ~(back[0][y] | back[1][y]);
+    still_burning |= back[0][y] | back[1][y];
+  }
+  
+  game->fire_front = !game->fire_front;
+  
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+    for(u32 bits = burned_out[y]; bits; bits &= bits - 1)
+    {
+      set_tile(ctx, __builtin_ctz(bits), y, glyph_ash);
+    }
+  }
+  
+  if(still_burning)
+  {
+    schedule_event(ctx, event_fire, 1);
+  }
+}
+
+typedef void event_callback_t(rebirth_ctx_t *ctx);
+
+global event_callback_t *event_callbacks[event_kind_count] =
+{
+  0,
+  start_blackout,
+  end_blackout,
+  spread_fire
+};
+
+// Advance the wheel and run what's due
+internal void
+advance_events(rebirth_ctx_t *ctx)
+{
+  game_t *game = &ctx->game;
+  game->event_turn++;
+  
+  if(!(game->event_turn % EVENT_WHEEL_SLOTS))
+  {
+    u8 *block = &game->event_wheel[1][(game->event_turn / EVENT_WHEEL_SLOTS) % EVENT_WHEEL_SLOTS];
+    for(u32 waiting = *block; waiting; waiting &= waiting - 1)
+    {
+      u32 kind = (u32)__builtin_ctz(waiting);
+      game->event_wheel[0][game->events[kind].due_turn % EVENT_WHEEL_SLOTS] |= (u8)(1 << kind);
+    }
+    
+    *block = 0;
+  }
+  
+  u8 *slot = &game->event_wheel[0][game->event_turn % EVENT_WHEEL_SLOTS];
+  u32 due = *slot;
+  *slot = 0;
+  
+  for(; due; due &= due - 1)
+  {
+    game_event_e kind = (game_event_e)__builtin_ctz(due);
+    game->events[kind].pending = false;
+    game->events[kind].due_turn = 0;
+    event_callbacks[kind](ctx);
+  }
+}
+
+internal inline u32
+get_state_code_nibble(u8 *nibbles, i32 i)
+{
+  return (nibbles[i / 2] >> ((i % 2) * 4)) & 0xF;
+}
+
+internal inline void
+set_state_code_nibble(u8 *nibbles, i32 i, u32 value)
+{
+  i32 shift = (i % 2) * 4;
+  nibbles[i / 2] = (u8)((nibbles[i / 2] & ~(0xF << shift)) | ((value & 0xF) << shift));
+}
+
+shared void
+encode_game_state(rebirth_ctx_t *ctx, state_code_t *code)
+{
+  memset(code, 0, sizeof(state_code_t));
+
+  // Ash is only ever a change to the level
+  for(u32 i = 0; i < ctx->room.change_count; i++)
+  {
+    tile_change_t *change = &ctx->room.changes[i];
+    if(change->glyph == glyph_ash)
+    {
+      code->ash[change->tile / 32] |= (u32)1 << (change->tile % 32);
+    }
+  }
+  
+  // A fire that's still going is coded as the ash it's going to leave
+  u32 footprint[ROOM_HEIGHT];
+  get_fire_footprint(ctx, footprint);
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+    for(u32 bits = footprint[y]; bits; bits &= bits - 1)
+    {
+      i32 tile = (y * ROOM_WIDTH) + __builtin_ctz(bits);
+      code->ash[tile / 32] |= (u32)1 << (tile % 32);
+    }
+  }
+
+  code->puzzle = ctx->game.puzzle;
+
+  code->searched = ctx->searched;
+
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->items[i].active && !ctx->items[i].in_inventory)
+    {
+      u16 floor_item = (u16)((ctx->items[i].type << 8) | ((ctx->items[i].y * ROOM_WIDTH) + ctx->items[i].x));
+
+      // Keep the list sorted so the order items were dropped in doesn't matter
+      i32 at = code->floor_item_count++;
+      while(at > 0 && code->floor_items[at - 1] > floor_item)
+      {
+        code->floor_items[at] = code->floor_items[at - 1];
+        at--;
+      }
+
+      code->floor_items[at] = floor_item;
+      set_state_code_nibble(code->use_counts, ctx->items[i].type, ctx->items[i].use_count);
+    }
+  }
+
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->player.inventory[i].in_inventory)
+    {
+      item_t *item = &ctx->player.inventory[i];
+      set_state_code_nibble(code->inventory, item->type,
+                            get_state_code_nibble(code->inventory, item->type) + 1);
+      set_state_code_nibble(code->use_counts, item->type, item->use_count);
+    }
+  }
+
+  code->player_x = (u8)ctx->player.x;
+  code->player_y = (u8)ctx->player.y;
+}
+
+shared void
+decode_game_state(rebirth_ctx_t *ctx, state_code_t *code)
+{
+  init_game_data(ctx);
+  ctx->game.state = state_play;
+
+  ctx->game.puzzle = code->puzzle;
+  if(is_puzzle_flag_set(ctx, puzzle_first_door_open))
+  {
+    open_first_door(ctx);
+  }
+
+  if(is_puzzle_flag_set(ctx, puzzle_second_door_open))
+  {
+    open_second_door(ctx);
+  }
+
+  for(i32 tile = 0; tile < ROOM_WIDTH * ROOM_HEIGHT; tile++)
+  {
+    if(code->ash[tile / 32] & ((u32)1 << (tile % 32)))
+    {
+      set_tile(ctx, tile % ROOM_WIDTH, tile / ROOM_WIDTH, glyph_ash);
+    }
+  }
+
+  ctx->searched = code->searched;
+
+  memset(&ctx->items, 0, sizeof(ctx->items));
+  for(i32 floor_i = 0; floor_i < code->floor_item_count; floor_i++)
+  {
+    item_e type = (item_e)(code->floor_items[floor_i] >> 8);
+    i32 tile = code->floor_items[floor_i] & 0xFF;
+
+    i32 item_id = add_item(ctx, tile % ROOM_WIDTH, tile / ROOM_WIDTH, type, get_max_use_count_for_item_type(type));
+    i32 i = get_item_pos_for_id(ctx, item_id);
+    if(i >= 0)
+    {
+      ctx->items[i].use_count = get_state_code_nibble(code->use_counts, type);
+    }
+  }
+
+  for(i32 type = item_none + 1; type < item_count; type++)
+  {
+    u32 count = get_state_code_nibble(code->inventory, type);
+    for(u32 count_i = 0; count_i < count; count_i++)
+    {
+      i32 item_id = add_item(ctx, 0, 0, type, get_max_use_count_for_item_type(type));
+      i32 i = get_item_pos_for_id(ctx, item_id);
+      if(i >= 0)
+      {
+        ctx->items[i].active = false;
+        ctx->items[i].in_inventory = true;
+        ctx->items[i].use_count = get_state_code_nibble(code->use_counts, type);
+        add_inventory_item(ctx, ctx->items[i]);
+      }
+    }
+  }
+
+  update_inventory_item_count(ctx);
+  
+  ctx->player.x = code->player_x;
+  ctx->player.y = code->player_y;
+}
+
+internal void
+put_packed_bits(bit_cursor_t *cursor, u32 value, u32 count)
+{
+  check_index((i32)((cursor->at + count + 7) / 8) - 1, PACKED_GAME_SIZE);
+  
+  // A byte at a time, as many bits as are left in it
+  while(count)
+  {
+    u32 shift = cursor->at % 8;
+    u32 taken = (8 - shift) < count ? (8 - shift) : count;
+    cursor->bits[cursor->at / 8] |= (u8)((value & ((1u << taken) - 1)) << shift);
+    
+    value >>= taken;
+    count -= taken;
+    cursor->at += taken;
+  }
+}
+
+internal u32
+get_packed_bits(bit_cursor_t *cursor, u32 count)
+{
+  u32 result = 0;
+  for(u32 got = 0; got < count;)
+  {
+    u32 shift = cursor->at % 8;
+    u32 taken = (8 - shift) < (count - got) ? (8 - shift) : (count - got);
+    result |= (u32)((cursor->bits[cursor->at / 8] >> shift) & ((1u << taken) - 1)) << got;
+    
+    got += taken;
+    cursor->at += taken;
+  }
+  
+  return result;
+}
+
+// Pack fields in as few bits as they need
+shared void
+pack_game(rebirth_ctx_t *ctx, packed_game_t *packed)
+{
+  memset(packed, 0, sizeof(packed_game_t));
+  bit_cursor_t cursor = {packed->bits, 0};
+  
+  game_t *game = &ctx->game;
+  put_packed_bits(&cursor, game->state, 3);
+  put_packed_bits(&cursor, game->event_turn, 8);
+  for(i32 i = event_none + 1; i < event_kind_count; i++)
+  {
+    put_packed_bits(&cursor, game->events[i].pending, 1);
+    if(game->events[i].pending)
+    {
+      put_packed_bits(&cursor, game->events[i].due_turn, 8);
+    }
+  }
+  put_packed_bits(&cursor, game->dark, 1);
+  
+  // Only a few tiles burn at once, so those are written with their counts
+  u32 burning[ROOM_HEIGHT];
+  get_burning_rows(ctx, burning);
+  
+  u32 burning_count = 0;
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+    burning_count += (u32)__builtin_popcount(burning[y]);
+  }
+  
+  put_packed_bits(&cursor, game->fire_front, 1);
+  put_packed_bits(&cursor, burning_count, 6);
+  u32 (*fire)[ROOM_HEIGHT] = game->fire[game->fire_front];
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+    for(u32 bits = burning[y]; bits; bits &= bits - 1)
+    {
+      i32 x = __builtin_ctz(bits);
+      put_packed_bits(&cursor, (u32)((y * ROOM_WIDTH) + x), 8);
+      put_packed_bits(&cursor, ((fire[0][y] >> x) & 1) | (((fire[1][y] >> x) & 1) << 1), 2);
+    }
+  }
+  
+  put_packed_bits(&cursor, (u32)game->menu_option_selected, 2);
+  put_packed_bits(&cursor, (u32)game->menu_option_count, 2);
+  put_packed_bits(&cursor, (u32)game->paragraph, 3);
+  put_packed_bits(&cursor, game->puzzle, 16);
+  
+  player_t *player = &ctx->player;
+  put_packed_bits(&cursor, (u32)player->x, 5);
+  put_packed_bits(&cursor, (u32)player->y, 4);
+  put_packed_bits(&cursor, (u32)player->turn, 32);
+  put_packed_bits(&cursor, (u32)player->input, 16);
+  put_packed_bits(&cursor, player->prompt, 3);
+  put_packed_bits(&cursor, (u32)player->use_x, 5);
+  put_packed_bits(&cursor, (u32)player->use_y, 4);
+  put_packed_bits(&cursor, (u32)player->travel_key, 7);
+  put_packed_bits(&cursor, player->inventory_enabled, 1);
+  put_packed_bits(&cursor, (u32)player->inventory_item_selected, 5);
+  put_packed_bits(&cursor, (u32)player->inventory_first_combination_item_num, 5);
+  put_packed_bits(&cursor, (u32)player->inventory_second_combination_item_num, 5);
+  put_packed_bits(&cursor, player->inventory_first_combination_item, 4);
+  put_packed_bits(&cursor, player->inventory_second_combination_item, 4);
+  
+  // The inventory has no gaps, so only the held items are written
+  put_packed_bits(&cursor, (u32)player->inventory_item_count, 5);
+  for(i32 i = 0; i < player->inventory_item_count; i++)
+  {
+    item_t *item = &player->inventory[i];
+    put_packed_bits(&cursor, item->type, 4);
+    put_packed_bits(&cursor, (u32)item->id, 8);
+    put_packed_bits(&cursor, (u32)item->x, 5);
+    put_packed_bits(&cursor, (u32)item->y, 4);
+    put_packed_bits(&cursor, (u32)item->use_count, 4);
+    put_packed_bits(&cursor, (u32)item->max_use_count, 4);
+  }
+  
+  put_packed_bits(&cursor, ctx->room.change_count, 6);
+  for(u32 i = 0; i < ctx->room.change_count; i++)
+  {
+    put_packed_bits(&cursor, ctx->room.changes[i].tile, 8);
+    put_packed_bits(&cursor, ctx->room.changes[i].glyph, 8);
+  }
+  
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    item_t *item = &ctx->items[i];
+    put_packed_bits(&cursor, item->active, 1);
+    put_packed_bits(&cursor, item->in_inventory, 1);
+    if(item->active || item->in_inventory)
+    {
+      put_packed_bits(&cursor, item->type, 4);
+      put_packed_bits(&cursor, (u32)item->id, 8);
+      put_packed_bits(&cursor, (u32)item->x, 5);
+      put_packed_bits(&cursor, (u32)item->y, 4);
+      put_packed_bits(&cursor, (u32)item->use_count, 4);
+      put_packed_bits(&cursor, (u32)item->max_use_count, 4);
+    }
+  }
+  
+  put_packed_bits(&cursor, ctx->searched, SEARCHABLE_COUNT);
+  
+  for(i32 tile = 0; tile < ROOM_WIDTH * ROOM_HEIGHT; tile += 32)
+  {
+    u32 count = ((ROOM_WIDTH * ROOM_HEIGHT) - tile) < 32 ? ((ROOM_WIDTH * ROOM_HEIGHT) - tile) : 32;
+    put_packed_bits(&cursor, ctx->seen[tile / 32], count);
+  }
+}
+
+shared void
+unpack_game(rebirth_ctx_t *ctx, packed_game_t *packed)
+{
+  init_game_data(ctx);
+  bit_cursor_t cursor = {packed->bits, 0};
+  
+  game_t *game = &ctx->game;
+  game->state = (game_state_e)get_packed_bits(&cursor, 3);
+  game->event_turn = (u8)get_packed_bits(&cursor, 8);
+  for(i32 i = event_none + 1; i < event_kind_count; i++)
+  {
+    if(get_packed_bits(&cursor, 1))
+    {
+      game->events[i].pending = true;
+      game->events[i].due_turn = (u8)get_packed_bits(&cursor, 8);
+      *get_event_slot(ctx, game->events[i].due_turn) |= (u8)(1 << i);
+    }
+  }
+  game->dark = get_packed_bits(&cursor, 1);
+  
+  game->fire_front = (u8)get_packed_bits(&cursor, 1);
+  u32 burning_count = get_packed_bits(&cursor, 6);
+  u32 (*fire)[ROOM_HEIGHT] = game->fire[game->fire_front];
+  for(u32 i = 0; i < burning_count; i++)
+  {
+    u32 tile = get_packed_bits(&cursor, 8);
+    u32 count = get_packed_bits(&cursor, 2);
+    fire[0][tile / ROOM_WIDTH] |= (count & 1) << (tile % ROOM_WIDTH);
+    fire[1][tile / ROOM_WIDTH] |= (count >> 1) << (tile % ROOM_WIDTH);
+  }
+  
+  game->menu_option_selected = (i32)get_packed_bits(&cursor, 2);
+  game->menu_option_count = (i32)get_packed_bits(&cursor, 2);
+  game->paragraph = (i32)get_packed_bits(&cursor, 3);
+  game->puzzle = (u16)get_packed_bits(&cursor, 16);
+  
+  player_t *player = &ctx->player;
+  player->x = (i32)get_packed_bits(&cursor, 5);
+  player->y = (i32)get_packed_bits(&cursor, 4);
+  player->turn = (i32)get_packed_bits(&cursor, 32);
+  player->input = (i32)get_packed_bits(&cursor, 16);
+  player->prompt = (prompt_e)get_packed_bits(&cursor, 3);
+  player->use_x = (i32)get_packed_bits(&cursor, 5);
+  player->use_y = (i32)get_packed_bits(&cursor, 4);
+  player->travel_key = (i32)get_packed_bits(&cursor, 7);
+  player->inventory_enabled = get_packed_bits(&cursor, 1);
+  player->inventory_item_selected = (i32)get_packed_bits(&cursor, 5);
+  player->inventory_first_combination_item_num = (i32)get_packed_bits(&cursor, 5);
+  player->inventory_second_combination_item_num = (i32)get_packed_bits(&cursor, 5);
+  player->inventory_first_combination_item = (item_e)get_packed_bits(&cursor, 4);
+  player->inventory_second_combination_item = (item_e)get_packed_bits(&cursor, 4);
+  
+  player->inventory_item_count = (i32)get_packed_bits(&cursor, 5);
+  for(i32 i = 0; i < player->inventory_item_count; i++)
+  {
+    item_t *item = &player->inventory[i];
+    item->in_inventory = true;
+    item->type = (item_e)get_packed_bits(&cursor, 4);
+    get_item_name_for_item_type(item->name, item->type);
+    item->id = (i32)get_packed_bits(&cursor, 8);
+    item->x = (i32)get_packed_bits(&cursor, 5);
+    item->y = (i32)get_packed_bits(&cursor, 4);
+    item->use_count = (i32)get_packed_bits(&cursor, 4);
+    item->max_use_count = (i32)get_packed_bits(&cursor, 4);
+    item->glyph = get_item_glyph_for_item_type(item->type);
+  }
+  
+  // The changes were written sorted, so they go back in as they are
+  ctx->room.change_count = get_packed_bits(&cursor, 6);
+  for(u32 i = 0; i < ctx->room.change_count; i++)
+  {
+    tile_change_t *change = &ctx->room.changes[i];
+    change->tile = (u8)get_packed_bits(&cursor, 8);
+    change->glyph = (u8)get_packed_bits(&cursor, 8);
+    ctx->room.changed[change->tile / 32] |= (u32)1 << (change->tile % 32);
+    set_room_bits(&ctx->room, change->tile % ROOM_WIDTH, change->tile / ROOM_WIDTH, change->glyph);
+  }
+  
+  memset(&ctx->items, 0, sizeof(ctx->items));
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    item_t *item = &ctx->items[i];
+    item->active = get_packed_bits(&cursor, 1);
+    item->in_inventory = get_packed_bits(&cursor, 1);
+    if(item->active || item->in_inventory)
+    {
+      item->type = (item_e)get_packed_bits(&cursor, 4);
+      get_item_name_for_item_type(item->name, item->type);
+      item->id = (i32)get_packed_bits(&cursor, 8);
+      item->x = (i32)get_packed_bits(&cursor, 5);
+      item->y = (i32)get_packed_bits(&cursor, 4);
+      item->use_count = (i32)get_packed_bits(&cursor, 4);
+      item->max_use_count = (i32)get_packed_bits(&cursor, 4);
+      item->glyph = get_item_glyph_for_item_type(item->type);
+    }
+  }
+  
+  ctx->searched = (u16)get_packed_bits(&cursor, SEARCHABLE_COUNT);
+  
+  for(i32 tile = 0; tile < ROOM_WIDTH * ROOM_HEIGHT; tile += 32)
+  {
+    u32 count = ((ROOM_WIDTH * ROOM_HEIGHT) - tile) < 32 ? ((ROOM_WIDTH * ROOM_HEIGHT) - tile) : 32;
+    ctx->seen[tile / 32] = get_packed_bits(&cursor, count);
+  }
+}
+
+internal inline b32
+are_state_codes_equal(state_code_t *a, state_code_t *b)
+{
+  return !memcmp(a, b, sizeof(state_code_t));
+}
+
+shared u64
+hash_state_code(state_code_t *code)
+{
+  u64 result = 0x9E3779B97F4A7C15;
+  u8 *at = (u8 *)code;
+
+  for(u32 i = 0; i < sizeof(state_code_t); i += sizeof(u64))
+  {
+    u64 word;
+    memcpy(&word, at + i, sizeof(word));
+
+    result = (result ^ word) * 0xFF51AFD7ED558CCD;
+    result ^= result >> 32;
+  }
+
+  result ^= result >> 29;
+  result *= 0xC4CEB9FE1A85EC53;
+  result ^= result >> 32;
+
+  return result;
+}
+
+internal void
+save_game(rebirth_ctx_t *ctx, game_snapshot_t *snapshot)
+{
+  snapshot->game = ctx->game;
+  snapshot->player = ctx->player;
+  snapshot->room = ctx->room;
+  memcpy(snapshot->items, ctx->items, sizeof(ctx->items));
+  snapshot->searched = ctx->searched;
+}
+
+internal void
+load_game(rebirth_ctx_t *ctx, game_snapshot_t *snapshot)
+{
+  ctx->game = snapshot->game;
+  ctx->player = snapshot->player;
+  ctx->room = snapshot->room;
+  memcpy(ctx->items, snapshot->items, sizeof(ctx->items));
+  ctx->searched = snapshot->searched;
+  invalidate_light(ctx);
+  ctx->travel.field_count = 0;
+}
+
+internal i32
+is_searchable(rebirth_ctx_t *ctx, i32 x, i32 y)
+{
+  i32 result = -1;
+  for(i32 i = 0; i < SEARCHABLE_COUNT; i++)
+  {
+    if(equal_pos(x, y, ctx->level->searchables[i].x, ctx->level->searchables[i].y))
+    {
+      if(is_searched(ctx, i))
+      {
+        result = 0;
+      }
+      else
+      {
+        result = 1;
+      }
+
+      break;
+    }
+  }
+  
+  return result;
+}
+
+internal void
+push_loot_message(rebirth_ctx_t *ctx, char **found_loot_names)
+{
+  i32 names_to_append = 0;
+  for(i32 i = 0; i < LOOT_COUNT; i++)
+  {
+    if(*found_loot_names[i] != glyph_blank)
+    {
+      names_to_append++;
+    }
+  }
+  
+  if(names_to_append == 1)
+  {
+    push_message(ctx, "You start searching..\n  you find something:\n  %s.",
+                   found_loot_names[0]);
+  }
+  else if(names_to_append == 2)
+  {
+    push_message(ctx, "You start searching..\n  you find a couple things:\n  %s,\n  %s.",
+                   found_loot_names[0], found_loot_names[1]);
+  }
+  else if(names_to_append == 3)
+  {
+    push_message(ctx, "You start searching..\n  you find multiple things:\n  %s,\n  %s,\n  %s.",
+                   found_loot_names[0], found_loot_names[1], found_loot_names[2]);
+  }
+}
+
+internal void
+add_searchable_loot(rebirth_ctx_t *ctx, i32 x, i32 y)
+{
+  for(i32 i = 0; i < SEARCHABLE_COUNT; i++)
+  {
+    if(equal_pos(x, y, ctx->level->searchables[i].x, ctx->level->searchables[i].y))
+    {
+      i32 loot_count = 0;
+      for(i32 loot_i = 0; loot_i < LOOT_COUNT; loot_i++)
+      {
+        loot_count += (ctx->level->searchables[i].loot[loot_i] != item_none);
+      }
+      
+      if(loot_count > get_free_item_count(ctx))
+      {
+        push_message(ctx, "You can't carry any more items.");
+        return;
+      }
+      
+      char *found_loot_names[LOOT_COUNT];
+      for(i32 i = 0; i < LOOT_COUNT; i++)
+      {
+        found_loot_names[i] = malloc(sizeof(char) * GENERAL_LENGTH);
+        *found_loot_names[i] = glyph_blank;
+      }
+      
+      for(i32 loot_i = 0; loot_i < LOOT_COUNT; loot_i++)
+      {
+        if(ctx->level->searchables[i].loot[loot_i])
+        {
+          get_item_name_for_item_type(found_loot_names[loot_i], ctx->level->searchables[i].loot[loot_i]);
+          
+          add_new_inventory_item(ctx, ctx->level->searchables[i].loot[loot_i]);
+        }
+      }
+      
+      push_loot_message(ctx, found_loot_names);
+      
+      for(i32 i = 0; i < LOOT_COUNT; i++)
+      {
+        free(found_loot_names[i]);
+      }
+      
+      ctx->searched |= (u16)(1 << i);
+      return;
+    }
+  }
+}
+
+internal void
+pick_up(rebirth_ctx_t *ctx, i32 x, i32 y)
+{
+  if(ctx->play_log)
+  {
+    log_play_event(ctx, play_pick_up, x, y, get_item_type_for_pos(ctx, x, y), item_none, 0);
+  }
+  
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->items[i].active)
+    {
+      if(equal_pos(x, y, ctx->items[i].x, ctx->items[i].y))
+      {
+        push_message(ctx, "You pick up the %s.", ctx->items[i].name);
+        add_inventory_item(ctx, ctx->items[i]);
+        ctx->items[i].active = false;
+        ctx->items[i].in_inventory = true;
+        return;
+      }
+    }
+  }
+  
+  switch(get_tile(ctx, x, y))
+  {
+    // NOTE(Rami): CONTINUE
+    case glyph_floor: push_message(ctx, "There's nothing there to pick up."); break;
+    case glyph_stone_door: push_message(ctx, "If only it was that simple."); break;
+    case glyph_wooden_door: push_message(ctx, "If only it was that simple."); break;
+    case glyph_torch: push_message(ctx, "You don't have a reason to pick that up."); break;
+    default: push_message(ctx, "You can't pick that up.");
+  }
+}
+
+internal void
+use_item(rebirth_ctx_t *ctx, i32 x, i32 y, i32 input)
+{
+  if(input >= 1 && input <= ITEM_COUNT)
+  {
+    check_index(input - 1, ITEM_COUNT);
+    item_t *item = &ctx->player.inventory[input - 1];
+    log_play_event(ctx, play_use, x, y, item->in_inventory ? item->type : item_none, item_none, 0);
+    if(item->in_inventory)
+    {
+      if(item->type == item_bunsen_burner && is_burning(ctx, x, y))
+      {
+        push_message(ctx, "It's already burning.");
+      }
+      else if(get_tile(ctx, x, y) == glyph_stone_door ||
+         get_tile(ctx, x, y) == glyph_stone_door_open)
+      {
+        if(item->type == item_bunsen_burner)
+        {
+          if(item->use_count < item->max_use_count)
+          {
+            push_message(ctx, "You use the bunsen burner on the stone door..\n  It barely even gets warm.");
+            item->use_count++;
+          }
+          else
+          {
+            push_message(ctx, "The bunsen burner doesn't seem to create a flame anymore..\n  You try adjusting the valve on the side of it but nothing happens.");
+          }
+        }
+        else if(is_puzzle_flag_set(ctx, puzzle_first_door_spade_inserted))
+        {
+          if(is_puzzle_flag_set(ctx, puzzle_first_door_cupric_sulfate_added))
+          {
+            if(is_puzzle_flag_set(ctx, puzzle_first_door_dihydrogen_monoxide_added))
+            {
+              push_message(ctx, "Nothing interesting happens.");
+            }
+            else
+            {
+              if(item->type == item_dihydrogen_monoxide)
+              {
+                push_message(ctx, "You pour the dihydrogen monoxide onto the cupric sulfate..\n  There's a reaction, you step back..\n  The spade gets hotter and expands a little.");
+                remove_inventory_item(ctx, input);
+                set_puzzle_flag(ctx, puzzle_first_door_dihydrogen_monoxide_added);
+                ctx->player.x--;
+              }
+              else
+              {
+                push_message(ctx, "Nothing interesting happens.");
+              }
+            }
+          }
+          else
+          {
+            if(item->type == item_cupric_sulfate)
+            {
+              push_message(ctx, "You pour the cupric sulfate onto the flat part of the spade.");
+              remove_inventory_item(ctx, input);
+              set_puzzle_flag(ctx, puzzle_first_door_cupric_sulfate_added);
+            }
+            else
+            {
+              push_message(ctx, "Nothing interesting happens.");
+            }
+          }
+        }
+        else
+        {
+          if(item->type == item_metal_spade_no_handle)
+          {
+            push_message(ctx, "You push the other end of the spade in the hole..\n  It fits quite nicely.");
+            remove_inventory_item(ctx, input);
+            set_puzzle_flag(ctx, puzzle_first_door_spade_inserted);
+          }
+          else
+          {
+            push_message(ctx, "Nothing interesting happens.");
+          }
+        }
+      }
+      else if(get_tile(ctx, x, y) == glyph_chain)
+      {
+        if(is_puzzle_flag_set(ctx, puzzle_second_door_key_imprint_made))
+        {
+          if(item->type == item_tin)
+          {
+            push_message(ctx, "You already made an imprint of the key.");
+          }
+          else
+          {
+            push_message(ctx, "You don't have a reason to do that.");
+          }
+        }
+        else
+        {
+          if(item->type == item_tin &&
+             is_puzzle_flag_set(ctx, puzzle_second_door_dihydrogen_monoxide_added) &&
+             is_puzzle_flag_set(ctx, puzzle_second_door_gypsum_added))
+          {
+            push_message(ctx, "You press the key against the white mixture..\n  It creates an impression of the key and hardens.");
+            set_puzzle_flag(ctx, puzzle_second_door_key_imprint_made);
+          }
+          else
+          {
+            push_message(ctx, "You don't have a reason to do that.");
+          }
+        }
+      }
+      else if(get_tile(ctx, x, y) == glyph_wooden_door)
+      {
+        if(is_puzzle_flag_set(ctx, puzzle_second_door_key_inserted))
+        {
+          push_message(ctx, "Nothing interesting happens.");
+        }
+        else
+        {
+          if(item->type == item_bronze_key && is_puzzle_flag_set(ctx, puzzle_second_door_key_pried))
+          {
+            push_message(ctx, "You insert the duplicate key and twist it..\n  You hear a loud click and the door is unlocked.");
+            remove_inventory_item(ctx, input);
+            set_puzzle_flag(ctx, puzzle_second_door_key_inserted);
+          }
+          else
+          {
+            push_message(ctx, "Nothing interesting happens.");
+          }
+        }
+      }
+      else if(get_tile(ctx, x, y) == glyph_chair)
+      {
+        if(item->type == item_bunsen_burner)
+        {
+          if(item->use_count < item->max_use_count)
+          {
+            push_message(ctx, "The chair slowly catches fire..");
+            ignite_tile(ctx, x, y);
+            item->use_count++;
+          }
+          else
+          {
+            push_message(ctx, "The bunsen burner doesn't seem to create a flame anymore..\n  You try adjusting the valve on the side of it but nothing happens.");
+          }
+        }
+        else
+        {
+          push_message(ctx, "Nothing interesting happens.");
+        }
+      }
+      else if(get_tile(ctx, x, y) == glyph_table)
+      {
+        if(item->type == item_bunsen_burner)
+        {
+          if(is_item_pos(ctx, x, y))
+          {
+            push_message(ctx, "You don't want to burn it because there's something on it");
+          }
+          else
+          {
+            if(item->use_count < item->max_use_count)
+            {
+              push_message(ctx, "The piece of table slowly catches fire..");
+              ignite_tile(ctx, x, y);
+              item->use_count++;
+            }
+            else
+            {
+              push_message(ctx, "The bunsen burner doesn't seem to create a flame anymore..\n  You try adjusting the valve on the side of it but nothing happens.");
+            }
+          }
+        }
+        else
+        {
+          push_message(ctx, "Nothing interesting happens.");
+        }
+      }
+      else if(get_tile(ctx, x, y) == glyph_bookshelf)
+      {
+        if(item->type == item_bunsen_burner)
+        {
+          if(item->use_count < item->max_use_count)
+          {
+            push_message(ctx, "The bookshelf slowly catches fire..");
+            ignite_tile(ctx, x, y);
+            item->use_count++;
+          }
+          else
+          {
+            push_message(ctx, "The bunsen burner doesn't seem to create a flame anymore..\n  You try adjusting the valve on the side of it but nothing happens.");
+          }
+        }
+        else
+        {
+          push_message(ctx, "Nothing interesting happens.");
+        }
+      }
+      else if(get_tile(ctx, x, y) == glyph_small_crate ||
+              get_tile(ctx, x, y) == glyph_crate)
+      {
+        if(item->type == item_bunsen_burner)
+        {
+          if(item->use_count < item->max_use_count)
+          {
+            if(get_tile(ctx, x, y) == glyph_small_crate)
+            {
+              push_message(ctx, "The small crate slowly catches fire..");
+            }
+            else
+            {
+              push_message(ctx, "The crate slowly catches fire..");
+            }
+
+            ignite_tile(ctx, x, y);
+            item->use_count++;
+          }
+          else
+          {
+            push_message(ctx, "The bunsen burner doesn't seem to create a flame anymore..\n  You try adjusting the valve on the side of it but nothing happens.");
+          }
+        }
+        else
+        {
+          push_message(ctx, "Nothing interesting happens.");
+        }
+      }
+      else if(get_tile(ctx, x, y) == glyph_open_chest)
+      {
+        if(item->type == item_bunsen_burner)
+        {
+          if(item->use_count < item->max_use_count)
+          {
+            push_message(ctx, "The chest slowly catches fire..");
+            ignite_tile(ctx, x, y);
+            item->use_count++;
+          }
+          else
+          {
+            push_message(ctx, "The bunsen burner doesn't seem to create a flame anymore..\n  You try adjusting the valve on the side of it but nothing happens.");
+          }
+        }
+        else
+        {
+          push_message(ctx, "Nothing interesting happens.");
+        }
+      }
+      else if(get_tile(ctx, x, y) == glyph_stone ||
+              get_tile(ctx, x, y) == glyph_floor ||
+              get_tile(ctx, x, y) == glyph_torch)
+      {
+        if(item->type == item_bunsen_burner)
+        {
+          if(get_tile(ctx, x, y) == glyph_stone)
+          {
+            push_message(ctx, "Seems like a waste to use it on a wall.");
+          }
+          else if(get_tile(ctx, x, y) == glyph_floor)
+          {
+            push_message(ctx, "Seems like a waste to use it on a floor.");
+          }
+          else
+          {
+            if(item->use_count < item->max_use_count)
+            {
+              push_message(ctx, "You use the bunsen burner on the torch..\n  It nurtures the fire and it slightly grows stronger.");
+              item->use_count++;
+            }
+            else
+            {
+              push_message(ctx, "The bunsen burner doesn't seem to create a flame anymore..\n  You try adjusting the valve on the side of it but nothing happens.");
+            }
+          }
+        }
+      }
+    }
+    else
+    {
+      push_message(ctx, "There's nothing to use in that inventory slot.");
+    }
+  }
+  else
+  {
+    push_message(ctx, "There's no such inventory slot.");
+  }
+}
+
+internal void
+interact(rebirth_ctx_t *ctx, i32 x, i32 y)
+{
+  log_play_event(ctx, play_interact, x, y, item_none, item_none, 0);
+  
+  if(is_burning(ctx, x, y))
+  {
+    push_message(ctx, "It's too hot to touch.");
+    return;
+  }
+  
+  i32 searchable = is_searchable(ctx, x, y);
+  if(searchable == 1)
+  {
+    add_searchable_loot(ctx, x, y);
+    return;
+  }
+  else if(searchable == 0)
+  {
+    switch(get_tile(ctx, x, y))
+    {
+      case glyph_bookshelf: push_message(ctx, "You search the bookshelf again..\n  You don't find anything interesting."); break;
+      case glyph_crate: push_message(ctx, "You search the crate again..\n  You don't find anything interesting."); break;
+    }
+    
+    return;
+  }
+  
+  if(get_tile(ctx, x, y) == glyph_stone_door ||
+     get_tile(ctx, x, y) == glyph_wooden_door)
+  {
+    if(get_tile(ctx, x, y) == glyph_stone_door)
+    {
+      if(is_puzzle_flag_set(ctx, puzzle_first_door_dihydrogen_monoxide_added))
+      {
+        push_message(ctx, "You pull on the spade..\n  It doesn't seem to budge so you pull hard on it..\n  The door slowly opens!");
+        ctx->player.x--;
+        
+        open_first_door(ctx);
+        schedule_event(ctx, event_blackout, 2);
+      }
+      else
+      {
+        if(is_puzzle_flag_set(ctx, puzzle_first_door_cupric_sulfate_added))
+        {
+          push_message(ctx, "Probably shouldn't move the spade because of the ingrients on it.");
+        }
+        else
+        {
+          if(is_puzzle_flag_set(ctx, puzzle_first_door_spade_inserted))
+          {
+            if(add_new_inventory_item(ctx, item_metal_spade_no_handle))
+            {
+              push_message(ctx, "You try to open the door using the spade as leverage..\n  The spade falls out since there's nothing actually holding it in place.\n  You pick it back up.");
+              unset_puzzle_flag(ctx, puzzle_first_door_spade_inserted);
+            }
+            else
+            {
+              push_message(ctx, "You can't carry any more items.");
+            }
+          }
+          else
+          {
+            push_message(ctx, "The door won't budge.");
+          }
+        }
+      }
+    }
+    else if(get_tile(ctx, x, y) == glyph_wooden_door)
+    {
+      if(is_puzzle_flag_set(ctx, puzzle_second_door_key_inserted))
+      {
+        push_message(ctx, "You twist the bronze key in the lock..\n  The door becomes unlocked and you open it.");
+        open_second_door(ctx);
+      }
+      else
+      {
+        push_message(ctx, "You try pushing the door as hard as you can..\n  It won't budge.");
+      }
+    }
+
+    return;
+  }
+
+  switch(get_tile(ctx, x, y))
+  {
+    case glyph_bookshelf: push_message(ctx, "You search the bookshelf..\n  you find nothing useful."); break;
+    case glyph_crate: push_message(ctx, "You search the crate..\n  you find nothing useful."); break;
+    case glyph_small_crate: push_message(ctx, "You search the small crate..\n  you find nothing useful."); break;
+    case glyph_open_chest: push_message(ctx, "There's nothing in there."); break;
+    case glyph_table: push_message(ctx, "You look under the table..\n  nothing but small rocks and dust."); break;
+    case glyph_chain: push_message(ctx, "You don't see a way of getting the key because of the chain."); break;
+    case glyph_stone_door_open: push_message(ctx, "You already opened it."); break;
+    case glyph_wooden_door_open: push_message(ctx, "You already opened it."); break;
+    case glyph_chair: push_message(ctx, "You contemplate sitting on it but you're not sure if it would break."); break;
+    default: push_message(ctx, "You don't see anything to do here.");
+  }
+}
+
+internal void
+inspect(rebirth_ctx_t *ctx, i32 x, i32 y)
+{
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->items[i].active)
+    {
+      if(equal_pos(x, y, ctx->items[i].x, ctx->items[i].y))
+      {
+        switch(ctx->items[i].glyph)
+        {
+          case glyph_metal_spade: push_message(ctx, "A metal spade, it's got a wooden handle to it."); break;
+          case glyph_metal_spade_no_handle: push_message(ctx, "A metal spade, it has no handle to it."); break;
+          case glyph_knife: push_message(ctx, "A rugged looking knife, I wonder what I could do with this."); break;
+          case glyph_magnet: push_message(ctx, "A curved magnet."); break;
+          case glyph_bunsen_burner: push_message(ctx, "A bunsen burner, good for combusting things."); break;
+          case glyph_bronze_key: push_message(ctx, "A bronze key, still a little warm."); break;
+          case glyph_tin:
+          {
+            if(is_puzzle_flag_set(ctx, puzzle_second_door_key_complete) && !is_puzzle_flag_set(ctx, puzzle_second_door_key_pried))
+            {
+              push_message(ctx, "A round container made out of tin..\n  There's a bronze key in the imprint.");
+            }
+            else if(is_puzzle_flag_set(ctx, puzzle_second_door_key_complete) && is_puzzle_flag_set(ctx, puzzle_second_door_key_pried))
+            {
+              push_message(ctx, "A round container made out of tin..\n  The bronze key that was in it has been pried away.");
+            }
+            else if(is_puzzle_flag_set(ctx, puzzle_second_door_cupric_ore_powder_added) && is_puzzle_flag_set(ctx, puzzle_second_door_tin_ore_powder_added))
+            {
+              push_message(ctx, "A round container made out of tin..\n  The key imprint has cupric and tin ore powder in it.");
+            }
+            else if(is_puzzle_flag_set(ctx, puzzle_second_door_cupric_ore_powder_added))
+            {
+              push_message(ctx, "A round container made out of tin..\n  The key imprint has cupric ore powder in it.");
+            }
+            else if(is_puzzle_flag_set(ctx, puzzle_second_door_tin_ore_powder_added))
+            {
+              push_message(ctx, "A round container made out of tin..\n  The key imprint has tin ore powder in it.");
+            }
+            else if(is_puzzle_flag_set(ctx, puzzle_second_door_key_imprint_made))
+            {
+              push_message(ctx, "A round container made out of tin..\n  It's filled with a lumpy white mixture that has an imprint of a key.");
+            }
+            else if(is_puzzle_flag_set(ctx, puzzle_second_door_gypsum_added) && is_puzzle_flag_set(ctx, puzzle_second_door_dihydrogen_monoxide_added))
+            {
+              push_message(ctx, "A round container made out of tin..\n  It's filled with a lumpy white mixture.");
+            }
+            else if(is_puzzle_flag_set(ctx, puzzle_second_door_gypsum_added))
+            {
+              push_message(ctx, "A round container made out of tin..\n  It has gypsum in it.");
+            }
+            else if(is_puzzle_flag_set(ctx, puzzle_second_door_dihydrogen_monoxide_added))
+            {
+              push_message(ctx, "A round container made out of tin..\n  It has dihydrogen monoxide in it.");
+            }
+            else
+            {
+              push_message(ctx, "A round container made out of tin.\n  I could probably pour something into this.");
+            }
+          } break;
+          case glyph_vial:
+          {
+            item_e type = get_item_type_for_pos(ctx, x, y);
+            if(type == item_empty_vial)
+            {
+              push_message(ctx, "It's a glass vial, it's empty.");
+            }
+            else if(type == item_dihydrogen_monoxide)
+            {
+              push_message(ctx, "A vial filled with clear blue liquid.\n  It has a label that says \"Dihydrogen Monoxide\".");
+            }
+            else if(type == item_cupric_ore_powder)
+            {
+              push_message(ctx, "A vial filled with orange liquid.\n  It has a label that says \"Powdered Cupric Ore\".");
+            }
+            else if(type == item_tin_ore_powder)
+            {
+              push_message(ctx, "A vial filled with dark liquid.\n  It has a label that says \"Powdered Tin Ore\".");
+            }
+            else if(type == item_sodium_chloride)
+            {
+              push_message(ctx, "A vial filled with a white substance.\n  It has a label that says \"Sodium Chloride\".");
+            }
+            else if(type == item_gypsum)
+            {
+              push_message(ctx, "A vial filled with gray liquid.\n  It has a label that says \"Gypsum\".");
+            }
+            else if(type == item_cupric_sulfate)
+            {
+              push_message(ctx, "A vial filled with a white substance.\n  It has a label that says \"Cupric Sulfate\".");
+            }
+            else if(type == item_acetic_acid)
+            {
+              push_message(ctx, "A vial filled with liquid that's dark green.\n  It has a label that says \"Acetic Acid\".");
+            }
+          } break;
+        }
+        
+        return;
+      }
+    }
+  }
+  
+  if(is_burning(ctx, x, y))
+  {
+    push_message(ctx, "The %s is burning.", get_glyph_name(get_tile(ctx, x, y)));
+    return;
+  }
+  
+  switch(get_tile(ctx, x, y))
+  {
+    case glyph_stone: push_message(ctx, "A stone surface, looks old and covered in moss."); break;
+    case glyph_floor: push_message(ctx, "An uneven stone floor, worms can be seen crawling around on it."); break;
+    case glyph_bookshelf: push_message(ctx, "A tall old bookshelf with some haphazardly placed books in it."); break;
+    case glyph_crate: push_message(ctx, "A large wooden crate."); break;
+    case glyph_small_crate: push_message(ctx, "A small wooden crate."); break;
+    case glyph_open_chest: push_message(ctx, "A wooden chest that's already open, it's completely empty."); break;
+    case glyph_table: push_message(ctx, "A worn down rickety table with text and markings all over it."); break;
+    case glyph_chair: push_message(ctx, "A chair exactly like the other ones in this room..\n  Some are missing their legs."); break;
+    case glyph_torch: push_message(ctx, "A lit torch on the wall, it burns calmly."); break;
+    case glyph_chain: push_message(ctx, "A stone surface with a big chain hanging from it all the way down to the ground..\n  There's a bronze key at the end of the chain."); break;
+    case glyph_stone_door_open: push_message(ctx, "It's the stone door but it's wide open this time."); break;
+    case glyph_wooden_door_open: push_message(ctx, "It's the wooden door but it's wide open this time."); break;
+    case glyph_ash: push_message(ctx, "There's wood ash scattered on the floor."); break;
+    case glyph_wooden_door:
+    {
+      if(is_puzzle_flag_set(ctx, puzzle_second_door_key_inserted))
+      {
+        push_message(ctx, "A door made out of wood..\n  It's got a bronze key inserted.");
+      }
+      else
+      {
+        push_message(ctx, "A door made out of wood..\n  It's got a lock on it with a keyhole.");
+      }
+    } break;
+    case glyph_stone_door:
+    {
+      if(is_puzzle_flag_set(ctx, puzzle_first_door_spade_inserted) &&
+         is_puzzle_flag_set(ctx, puzzle_first_door_cupric_sulfate_added) &&
+         is_puzzle_flag_set(ctx, puzzle_first_door_dihydrogen_monoxide_added))
+      {
+        push_message(ctx, "The spade is warm and has slightly expanded.");
+      }
+      else if(is_puzzle_flag_set(ctx, puzzle_first_door_spade_inserted) && is_puzzle_flag_set(ctx, puzzle_first_door_cupric_sulfate_added))
+      {
+        push_message(ctx, "The spade has cupric sulfate on it.");
+      }
+      else if(is_puzzle_flag_set(ctx, puzzle_first_door_spade_inserted))
+      {
+        push_message(ctx, "The spade is sticking out of the hole in the door.");
+      }
+      else
+      {
+        push_message(ctx, "A door but it's thick and made out of stone!\n  It seems to have a hole in it that doesn't fully go through.");
+      }
+    } break;
+  }
+}
+
+internal void
+combine(rebirth_ctx_t *ctx, item_e first_type, item_e second_type)
+{
+  log_play_event(ctx, play_combine, ctx->player.x, ctx->player.y, first_type, second_type, 0);
+  
+  char first_name[GENERAL_LENGTH];
+  char second_name[GENERAL_LENGTH];
+  
+  get_item_name_for_item_type(first_name, first_type);
+  get_item_name_for_item_type(second_name, second_type);
+  
+  if((first_type == item_metal_spade && second_type == item_bunsen_burner) ||
+     (first_type == item_bunsen_burner && second_type == item_metal_spade))
+  {
+    i32 burner = get_inventory_position_for_item_type(ctx, item_bunsen_burner);
+    check_index(burner, ITEM_COUNT);
+    if(ctx->player.inventory[burner].use_count < ctx->player.inventory[burner].max_use_count)
+    {
+      push_message(ctx, "You use the bunsen burner to burn the handle away from the spade..\n  You are left with a metal spade that has no handle.", first_name, second_name);
+    
+      if(first_type == item_metal_spade)
+      {
+        remove_inventory_item(ctx, ctx->player.inventory_first_combination_item_num);
+      }
+      else
+      {
+        remove_inventory_item(ctx, ctx->player.inventory_second_combination_item_num);
+      }
+    
+      // The spade that was taken away left a free item
+      add_new_inventory_item(ctx, item_metal_spade_no_handle);
+
+      i32 i = get_inventory_position_for_item_type(ctx, item_bunsen_burner);
+      check_index(i, ITEM_COUNT);
+      ctx->player.inventory[i].use_count++;
+    }
+    else
+    {
+      push_message(ctx, "The bunsen burner doesn't seem to create a flame anymore..\n  You try adjusting the valve on the side of it but nothing happens.");
+    }
+  }
+  else if((first_type == item_metal_spade_no_handle && second_type == item_bunsen_burner) ||
+     (first_type == item_bunsen_burner && second_type == item_metal_spade_no_handle))
+  {
+    push_message(ctx, "There's no wood left to burn on the metal spade.");
+  }
+  else if((first_type == item_tin && second_type == item_dihydrogen_monoxide) ||
+          (first_type == item_dihydrogen_monoxide && second_type == item_tin))
+  {
+    if(is_puzzle_flag_set(ctx, puzzle_second_door_dihydrogen_monoxide_added))
+    {
+      push_message(ctx, "There's already some dihydrogen monoxide in the tin.");
+    }
+    else
+    {
+      if(is_puzzle_flag_set(ctx, puzzle_second_door_gypsum_added))
+      {
+        push_message(ctx, "You pour the dihydrogen monoxide in the tin..\n  The result is a lumpy white mixture.");
+      }
+      else
+      {
+        push_message(ctx, "You pour the dihydrogen monoxide in the tin..");
+      }
+      
+      if(first_type == item_dihydrogen_monoxide)
+      {
+        remove_inventory_item(ctx, ctx->player.inventory_first_combination_item_num);
+      }
+      else
+      {
+        remove_inventory_item(ctx, ctx->player.inventory_second_combination_item_num);
+      }
+      
+      set_puzzle_flag(ctx, puzzle_second_door_dihydrogen_monoxide_added);
+    }
+  }
+  else if((first_type == item_tin && second_type == item_gypsum) ||
+          (first_type == item_gypsum && second_type == item_tin))
+  {
+    if(is_puzzle_flag_set(ctx, puzzle_second_door_dihydrogen_monoxide_added))
+    {
+      push_message(ctx, "You pour the gypsum in the tin..\n  The result is a lumpy white mixture.");
+    }
+    else
+    {
+      push_message(ctx, "You pour the gypsum in the tin.");
+    }
+    
+    if(first_type == item_gypsum)
+    {
+      remove_inventory_item(ctx, ctx->player.inventory_first_combination_item_num);
+    }
+    else
+    {
+      remove_inventory_item(ctx, ctx->player.inventory_second_combination_item_num);
+    }
+    
+    set_puzzle_flag(ctx, puzzle_second_door_gypsum_added);
+  }
+  else if((first_type == item_tin && second_type == item_cupric_ore_powder) ||
+          (first_type == item_cupric_ore_powder && second_type == item_tin))
+  {
+    if(is_puzzle_flag_set(ctx, puzzle_second_door_key_imprint_made))
+    {
+      if(first_type == item_cupric_ore_powder)
+      {
+        remove_inventory_item(ctx, ctx->player.inventory_first_combination_item_num);
+      }
+      else
+      {
+        remove_inventory_item(ctx, ctx->player.inventory_second_combination_item_num);
+      }
+      
+      push_message(ctx, "You pour the cupric ore powder into the impression of the key.");
+      set_puzzle_flag(ctx, puzzle_second_door_cupric_ore_powder_added);
+    }
+    else
+    {
+      push_message(ctx, "Nothing interesting happens.");
+    }
+  }
+  else if((first_type == item_tin && second_type == item_tin_ore_powder) ||
+          (first_type == item_tin_ore_powder && second_type == item_tin))
+  {
+    if(is_puzzle_flag_set(ctx, puzzle_second_door_key_imprint_made))
+    {
+      if(first_type == item_tin_ore_powder)
+      {
+        remove_inventory_item(ctx, ctx->player.inventory_first_combination_item_num);
+      }
+      else
+      {
+        remove_inventory_item(ctx, ctx->player.inventory_second_combination_item_num);
+      }
+      
+      push_message(ctx, "You pour the tin ore powder into the impression of the key.");
+      set_puzzle_flag(ctx, puzzle_second_door_tin_ore_powder_added);
+    }
+    else
+    {
+      push_message(ctx, "Nothing interesting happens.");
+    }
+  }
+  else if((first_type == item_tin && second_type == item_bunsen_burner) ||
+          (first_type == item_bunsen_burner && second_type == item_tin))
+  {
+    i32 burner = get_inventory_position_for_item_type(ctx, item_bunsen_burner);
+    check_index(burner, ITEM_COUNT);
+    if(ctx->player.inventory[burner].use_count >= ctx->player.inventory[burner].max_use_count)
+    {
+      push_message(ctx, "The bunsen burner doesn't seem to create a flame anymore..\n  You try adjusting the valve on the side of it but nothing happens.");
+    }
+    else if(is_puzzle_flag_set(ctx, puzzle_second_door_cupric_ore_powder_added) &&
+            is_puzzle_flag_set(ctx, puzzle_second_door_tin_ore_powder_added))
+    {
+      push_message(ctx, "You heat the two powdered ores together in the tin..\n  You make a duplicate of the key in bronze.");
+
+      ctx->player.inventory[burner].use_count++;
+
+      set_puzzle_flag(ctx, puzzle_second_door_key_complete);
+    }
+    else
+    {
+      push_message(ctx, "Nothing interesting happens.");
+    }
+  }
+  else if((first_type == item_knife && second_type == item_tin) ||
+          (first_type == item_tin && second_type == item_knife))
+  {
+    if(is_puzzle_flag_set(ctx, puzzle_second_door_key_complete) &&
+       !is_puzzle_flag_set(ctx, puzzle_second_door_key_pried))
+    {
+      if(add_new_inventory_item(ctx, item_bronze_key))
+      {
+        push_message(ctx, "You pry the duplicate bronze key out of the tin.");
+        set_puzzle_flag(ctx, puzzle_second_door_key_pried);
+      }
+      else
+      {
+        push_message(ctx, "You can't carry any more items.");
+      }
+    }
+    else
+    {
+      push_message(ctx, "Nothing interesting happens.");
+    }
+  }
+  else
+  {
+    push_message(ctx, "Nothing interesting happens.");
+  }
+  
+  reset_inventory_selections(ctx);
+}
+
+internal i32
+did_escape(rebirth_ctx_t *ctx)
+{
+  i32 result = 0;
+  if(ctx->player.x == WOODEN_DOOR_X && ctx->player.y == ctx->level->exit_y)
+  {
+    result = 1;
+  }
+  
+  return result;
+}
+
+// Start from the tiles next to the target
+internal travel_field_t *
+get_travel_field(rebirth_ctx_t *ctx, i32 target_x, i32 target_y)
+{
+  travel_t *travel = &ctx->travel;
+  u8 target = (u8)((target_y * ROOM_WIDTH) + target_x);
+  
+  for(u32 i = 0; i < travel->field_count; i++)
+  {
+    if(travel->fields[i].target == target)
+    {
+      return &travel->fields[i];
+    }
+  }
+  
+  travel_field_t *field = 0;
+  if(travel->field_count < TRAVEL_FIELD_COUNT)
+  {
+    field = &travel->fields[travel->field_count++];
+  }
+  else
+  {
+    field = &travel->fields[travel->next_replaced];
+    travel->next_replaced = (travel->next_replaced + 1) % TRAVEL_FIELD_COUNT;
+  }
+  
+  field->target = target;
+  memset(field->distance, TRAVEL_UNREACHABLE, sizeof(field->distance));
+  
+  u32 frontier[ROOM_HEIGHT] = {0};
+  u32 reached[ROOM_HEIGHT] = {0};
+  u32 stepped[4][ROOM_HEIGHT];
+  frontier[target_y] = (u32)1 << target_x;
+  
+  for(u8 distance = 0; step_room_flood(ctx, frontier, reached, stepped); distance++)
+  {
+    for(i32 y = 0; y < ROOM_HEIGHT; y++)
+    {
+      for(u32 bits = frontier[y]; bits; bits &= bits - 1)
+      {
+        field->distance[__builtin_ctz(bits)][y] = distance;
+      }
+    }
+  }
+  
+  return field;
+}
+
+// Reachable targets of the kind, nearest first, a target the player is on
+// or next to is at distance zero
+internal i32
+get_travel_targets(rebirth_ctx_t *ctx, i32 key, u8 *targets, u8 *distances)
+{
+  i32 candidate_count = 0;
+  u8 candidates[ROOM_WIDTH * ROOM_HEIGHT];
+  
+  if(key == 'i')
+  {
+    for(i32 i = 0; i < ITEM_COUNT; i++)
+    {
+      if(ctx->items[i].active)
+      {
+        candidates[candidate_count++] = (u8)((ctx->items[i].y * ROOM_WIDTH) + ctx->items[i].x);
+      }
+    }
+  }
+  else if(key == 's')
+  {
+    for(i32 i = 0; i < SEARCHABLE_COUNT; i++)
+    {
+      if(!is_searched(ctx, i))
+      {
+        candidates[candidate_count++] = (u8)((ctx->level->searchables[i].y * ROOM_WIDTH) + ctx->level->searchables[i].x);
+      }
+    }
+  }
+  else if(key == 'd')
+  {
+    for(i32 y = 0; y < ROOM_HEIGHT; y++)
+    {
+      for(i32 x = 0; x < ROOM_WIDTH; x++)
+      {
+        u8 glyph = get_tile(ctx, x, y);
+        if(glyph == glyph_stone_door ||
+           glyph == glyph_stone_door_open ||
+           glyph == glyph_wooden_door ||
+           glyph == glyph_wooden_door_open)
+        {
+          candidates[candidate_count++] = (u8)((y * ROOM_WIDTH) + x);
+        }
+      }
+    }
+  }
+  
+  i32 result = 0;
+  for(i32 i = 0; i < candidate_count; i++)
+  {
+    travel_field_t *field = get_travel_field(ctx, candidates[i] % ROOM_WIDTH, candidates[i] / ROOM_WIDTH);
+    u8 distance = field->distance[ctx->player.x][ctx->player.y];
+    
+    if(equal_pos(ctx->player.x, ctx->player.y, candidates[i] % ROOM_WIDTH, candidates[i] / ROOM_WIDTH))
+    {
+      distance = 0;
+    }
+    
+    if(distance != TRAVEL_UNREACHABLE)
+    {
+      // Equally far targets stay in the order they were found
+      i32 at = result++;
+      while(at && distances[at - 1] > distance)
+      {
+        targets[at] = targets[at - 1];
+        distances[at] = distances[at - 1];
+        at--;
+      }
+      
+      targets[at] = candidates[i];
+      distances[at] = distance;
+    }
+  }
+  
+  return result;
+}
+
+internal void
+get_travel_target_name(rebirth_ctx_t *ctx, char *storage, i32 key, u8 target)
+{
+  i32 x = target % ROOM_WIDTH;
+  i32 y = target / ROOM_WIDTH;
+  
+  if(key == 'i')
+  {
+    get_item_name_for_item_type(storage, get_item_type_for_pos(ctx, x, y));
+  }
+  else
+  {
+    snprintf(storage, GENERAL_LENGTH, "%s", get_glyph_name(get_tile(ctx, x, y)));
+  }
+}
+
+// A turn per step
+internal void
+walk_to_travel_target(rebirth_ctx_t *ctx, i32 key, u8 target)
+{
+  char name[GENERAL_LENGTH];
+  get_travel_target_name(ctx, name, key, target);
+  
+  // More targets than fields can have pushed out the one picked
+  travel_field_t *field = get_travel_field(ctx, target % ROOM_WIDTH, target / ROOM_WIDTH);
+  
+  if(!field->distance[ctx->player.x][ctx->player.y] ||
+     equal_pos(ctx->player.x, ctx->player.y, target % ROOM_WIDTH, target / ROOM_WIDTH))
+  {
+    push_message(ctx, "You're already at the %s.", name);
+    return;
+  }
+  
+  for(i32 step = 0; field->distance[ctx->player.x][ctx->player.y]; step++)
+  {
+    // The key that started the walk took the first turn already
+    if(step)
+    {
+      advance_events(ctx);
+    }
+    
+    for(i32 direction = 0; direction < 4; direction++)
+    {
+      i32 x = ctx->player.x + direction_x[direction];
+      i32 y = ctx->player.y + direction_y[direction];
+      
+      if(x >= 0 && x < ROOM_WIDTH &&
+         y >= 0 && y < ROOM_HEIGHT &&
+         field->distance[x][y] + 1 == field->distance[ctx->player.x][ctx->player.y])
+      {
+        ctx->player.x = x;
+        ctx->player.y = y;
+        break;
+      }
+    }
+    
+    ctx->player.turn++;
+    update_light(ctx);
+  }
+  
+  push_message(ctx, "You walk over to the %s.", name);
+}
+
+// Goes straight to the only target, otherwise asks which one
+internal void
+travel_to(rebirth_ctx_t *ctx, i32 key)
+{
+  if(key != 'i' && key != 's' && key != 'd')
+  {
+    push_message(ctx, "You stay where you are.");
+    return;
+  }
+  
+  u8 targets[ROOM_WIDTH * ROOM_HEIGHT];
+  u8 distances[ROOM_WIDTH * ROOM_HEIGHT];
+  i32 target_count = get_travel_targets(ctx, key, targets, distances);
+  
+  if(!target_count)
+  {
+    push_message(ctx, "There's nowhere like that you can get to from here.");
+  }
+  else if(target_count == 1)
+  {
+    walk_to_travel_target(ctx, key, targets[0]);
+  }
+  else
+  {
+    char choices[MAX_LENGTH] = "Which one?";
+    for(i32 i = 0; i < target_count && i < TRAVEL_CHOICE_COUNT; i++)
+    {
+      char name[GENERAL_LENGTH];
+      get_travel_target_name(ctx, name, key, targets[i]);
+      
+      u32 length = (u32)strlen(choices);
+      if(!distances[i])
+      {
+        snprintf(choices + length, sizeof(choices) - length, "\n  (%c) %s, right here", 'a' + i, name);
+      }
+      else
+      {
+        snprintf(choices + length, sizeof(choices) - length, "\n  (%c) %s, %d step%s", 'a' + i, name, distances[i], (distances[i] == 1) ? "" : "s");
+      }
+    }
+    
+    push_message(ctx, "%s", choices);
+    ctx->player.travel_key = key;
+    ctx->player.prompt = prompt_travel_choice;
+  }
+}
+
+// The targets are the same as when they were listed, answering takes no turn
+internal void
+travel_to_choice(rebirth_ctx_t *ctx, i32 key)
+{
+  u8 targets[ROOM_WIDTH * ROOM_HEIGHT];
+  u8 distances[ROOM_WIDTH * ROOM_HEIGHT];
+  i32 target_count = get_travel_targets(ctx, ctx->player.travel_key, targets, distances);
+  
+  i32 choice = key - 'a';
+  if(choice >= 0 && choice < target_count && choice < TRAVEL_CHOICE_COUNT)
+  {
+    walk_to_travel_target(ctx, ctx->player.travel_key, targets[choice]);
+  }
+  else
+  {
+    push_message(ctx, "You stay where you are.");
+  }
+}
+
+internal void
+player_keypress(rebirth_ctx_t *ctx, i32 key)
+{
+  log_play_event(ctx, play_key, ctx->player.x, ctx->player.y, item_none, item_none, 0);
+  
+  i32 player_new_x = ctx->player.x;
+  i32 player_new_y = ctx->player.y;
+  
+  if(ctx->player.inventory_enabled)
+  {
+    if(key == 'b')
+    {
+      ctx->player.inventory_enabled = false;
+      ctx->player.inventory_item_selected = 0;
+      reset_inventory_selections(ctx);
+    }
+    else if(key == 'w')
+    {
+      // Move to the item above
+      if((ctx->player.inventory_item_selected - 1) < 1)
+      {
+        ctx->player.inventory_item_selected = ctx->player.inventory_item_count;
+      }
+      else
+      {
+        ctx->player.inventory_item_selected--;
+      }
+    }
+    else if(key == 's')
+    {
+      // Move to the item below
+      if((ctx->player.inventory_item_selected + 1) > ctx->player.inventory_item_count)
+      {
+        ctx->player.inventory_item_selected = 1;
+      }
+      else
+      {
+        ctx->player.inventory_item_selected++;
+      }
+    }
+    else if(key == 'd')
+    {
+      drop_inventory_item(ctx, player_new_x, player_new_y, ctx->player.inventory_item_selected);
+    }
+    else if(key == 'c')
+    {
+      if(ctx->player.inventory_first_combination_item == item_none)
+      {
+        ctx->player.inventory_first_combination_item_num = ctx->player.inventory_item_selected;
+        ctx->player.inventory_first_combination_item = get_item_type_for_inventory_position(ctx, ctx->player.inventory_item_selected);
+      }
+      else if(ctx->player.inventory_second_combination_item == item_none)
+      {
+        ctx->player.inventory_second_combination_item_num = ctx->player.inventory_item_selected;
+        
+        if(ctx->player.inventory_first_combination_item_num == ctx->player.inventory_second_combination_item_num)
+        {
+          push_message(ctx, "Nothing interesting happens.");
+          reset_inventory_selections(ctx);
+        }
+        else
+        {
+          ctx->player.inventory_second_combination_item = get_item_type_for_inventory_position(ctx, ctx->player.inventory_item_selected);
+          trace_begin("combine");
+          combine(ctx, ctx->player.inventory_first_combination_item, ctx->player.inventory_second_combination_item);
+          trace_end();
+        }
+      }
+    }
+  }
+  else if(ctx->player.prompt == prompt_use_slot)
+  {
+    ctx->player.prompt = prompt_none;
+    trace_begin("use_item");
+    use_item(ctx, ctx->player.use_x, ctx->player.use_y, key - ASCII_LOWERCASE_START);
+    trace_end();
+  }
+  else if(ctx->player.prompt == prompt_travel_target)
+  {
+    ctx->player.prompt = prompt_none;
+    travel_to(ctx, key);
+  }
+  else if(ctx->player.prompt == prompt_travel_choice)
+  {
+    ctx->player.prompt = prompt_none;
+    travel_to_choice(ctx, key);
+  }
+  else if(ctx->player.prompt)
+  {
+    // The rest of the prompts ask for a direction
+    if(key == 'w')
+    {
+      player_new_y--;
+    }
+    else if(key == 's')
+    {
+      player_new_y++;
+    }
+    else if(key == 'a')
+    {
+      player_new_x--;
+    }
+    else if(key == 'd')
+    {
+      player_new_x++;
+    }
+    
+    prompt_e prompt = ctx->player.prompt;
+    ctx->player.prompt = prompt_none;
+    
+    switch(prompt)
+    {
+      case prompt_use_direction:
+      {
+        push_message(ctx, "What item do you want to use? (enter inventory character)");
+        ctx->player.use_x = player_new_x;
+        ctx->player.use_y = player_new_y;
+        ctx->player.prompt = prompt_use_slot;
+      } break;
+      
+      case prompt_pick_up_direction: pick_up(ctx, player_new_x, player_new_y); break;
+      
+      case prompt_interact_direction:
+      {
+        trace_begin("interact");
+        interact(ctx, player_new_x, player_new_y);
+        trace_end();
+      } break;
+      
+      case prompt_inspect_direction: inspect(ctx, player_new_x, player_new_y); break;
+      default: break;
+    }
+  }
+  else
+  {
+    if(key == 'w')
+    {
+      player_new_y--;
+    }
+    else if(key == 's')
+    {
+      player_new_y++;
+    }
+    else if(key == 'a')
+    {
+      player_new_x--;
+    }
+    else if(key == 'd')
+    {
+      player_new_x++;
+    }
+    else if(key == 'u')
+    {
+      if(ctx->player.inventory_item_count)
+      {
+        push_message(ctx, "Where do you want to use the item?");
+        ctx->player.prompt = prompt_use_direction;
+      }
+      else
+      {
+        push_message(ctx, "You don't have anything to use.");
+      }
+    }
+    else if(key == 'i')
+    {
+      push_message(ctx, "What do you want to interact with?");
+      ctx->player.prompt = prompt_interact_direction;
+    }
+    else if(key == 'o')
+    {
+      push_message(ctx, "What do you want to inspect?");
+      ctx->player.prompt = prompt_inspect_direction;
+    }
+    else if(key == 'p')
+    {
+      push_message(ctx, "What do you want to pickup?");
+      ctx->player.prompt = prompt_pick_up_direction;
+    }
+    else if(key == 't')
+    {
+      push_message(ctx, "Where do you want to go? (I) an item, (S) something to search, (D) a door");
+      ctx->player.prompt = prompt_travel_target;
+    }
+    else if(key == '.')
+    {
+      // Nothing but the turn passing
+    }
+    else if(key == 'b')
+    {
+      if(ctx->player.inventory_item_count)
+      {
+        ctx->player.inventory_enabled = true;
+        ctx->player.inventory_item_selected = 1;
+      }
+      else
+      {
+        push_message(ctx, "Your inventory is empty.");
+      }
+    }
+    
+    if(is_traversable(ctx, player_new_x, player_new_y))
+    {
+      ctx->player.x = player_new_x;
+      ctx->player.y = player_new_y;
+    }
+    
+    ctx->player.turn++;
+  }
+  
+  update_inventory_item_count(ctx);
+  
+  if(did_escape(ctx))
+  {
+    ctx->game.state = state_outro;
+  }
+}
+
+internal void
+update_game(rebirth_ctx_t *ctx, i32 input)
+{
+  ctx->player.input = input;
+  ctx->game.message[0] = 0;
+  
+  if(ctx->player.prompt == prompt_use_slot ||
+     ctx->player.prompt == prompt_travel_choice)
+  {
+    // Any key answers the slot and travel choice prompts
+    player_keypress(ctx, ctx->player.input);
+    return;
+  }
+  
+  advance_events(ctx);
+  
+  if(is_valid_input(ctx->player.input))
+  {
+    if(ctx->player.input == 'q')
+    {
+      init_game_data(ctx);
+      ctx->game.state = state_main_menu;
+    }
+    else
+    {
+      player_keypress(ctx, ctx->player.input);
+    }
+  }
+}
+
+// One character per key, '#' starts a comment
+shared b32
+load_key_sequence(key_sequence_t *sequence, char *path)
+{
+  memset(sequence, 0, sizeof(key_sequence_t));
+  
+  FILE *file = fopen(path, "rb");
+  if(!file)
+  {
+    return false;
+  }
+  
+  fseek(file, 0, SEEK_END);
+  i32 size = (i32)ftell(file);
+  fseek(file, 0, SEEK_SET);
+  
+  sequence->keys = malloc(size + 1);
+  b32 in_comment = false;
+  
+  i32 c;
+  while((c = fgetc(file)) != EOF)
+  {
+    if(c == '#')
+    {
+      in_comment = true;
+    }
+    else if(c == '\n')
+    {
+      in_comment = false;
+    }
+    else if(!in_comment && c != ' ' && c != '\t' && c != '\r')
+    {
+      sequence->keys[sequence->count++] = (u8)c;
+    }
+  }
+  
+  fclose(file);
+  return true;
+}
+
+// Rows, start, exit row, items and searchables, one to a line
+shared void
+write_level(FILE *file, level_t *level)
+{
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+    fprintf(file, "%s\n", (char *)level->room[y]);
+  }
+  
+  fprintf(file, "start %d %d\n", level->start_x, level->start_y);
+  fprintf(file, "exit %d\n", level->exit_y);
+  
+  for(i32 i = 0; i < LEVEL_ITEM_COUNT; i++)
+  {
+    level_item_t *item = &level->items[i];
+    fprintf(file, "item %d %d %d %d\n", item->x, item->y, item->type, item->max_use_count);
+  }
+  
+  for(i32 i = 0; i < SEARCHABLE_COUNT; i++)
+  {
+    searchable_t *searchable = &level->searchables[i];
+    fprintf(file, "search %d %d %d %d %d\n", searchable->x, searchable->y,
+            searchable->loot[0], searchable->loot[1], searchable->loot[2]);
+  }
+}
+
+internal b32
+is_level_pos(i32 x, i32 y)
+{
+  b32 result = (x >= 0 && x < ROOM_WIDTH && y >= 0 && y < ROOM_HEIGHT);
+  return result;
+}
+
+internal b32
+is_level_item_type(i32 type)
+{
+  b32 result = (type >= item_none && type < item_count);
+  return result;
+}
+
+// Doesn't check that the level can be escaped
+shared b32
+load_level(level_t *level, char *path)
+{
+  memset(level, 0, sizeof(level_t));
+  
+  FILE *file = fopen(path, "rb");
+  if(!file)
+  {
+    return false;
+  }
+  
+  i32 row_count = 0;
+  i32 item_count = 0;
+  i32 searchable_count = 0;
+  b32 has_start = false;
+  b32 has_exit = false;
+  b32 valid = true;
+  
+  char line[MAX_LENGTH];
+  while(valid && fgets(line, sizeof(line), file))
+  {
+    line[strcspn(line, "\r\n")] = 0;
+    
+    i32 a;
+    i32 b;
+    i32 c;
+    i32 d;
+    i32 e;
+    
+    if(!line[0] || (line[0] == '#' && line[1] == ' '))
+    {
+      continue;
+    }
+    else if(row_count < ROOM_HEIGHT)
+    {
+      valid = (strlen(line) == ROOM_WIDTH);
+      memcpy(level->room[row_count++], line, ROOM_WIDTH);
+    }
+    else if(sscanf(line, "start %d %d", &a, &b) == 2)
+    {
+      valid = is_level_pos(a, b);
+      level->start_x = a;
+      level->start_y = b;
+      has_start = true;
+    }
+    else if(sscanf(line, "exit %d", &a) == 1)
+    {
+      valid = (a > 0 && a < ROOM_HEIGHT - 1);
+      level->exit_y = a;
+      has_exit = true;
+    }
+    else if(sscanf(line, "item %d %d %d %d", &a, &b, &c, &d) == 4 && item_count < LEVEL_ITEM_COUNT)
+    {
+      valid = is_level_pos(a, b) && is_level_item_type(c) && c != item_none && d >= 0 && d < 16;
+      
+      level_item_t *item = &level->items[item_count++];
+      item->x = a;
+      item->y = b;
+      item->type = (item_e)c;
+      item->max_use_count = d;
+    }
+    else if(sscanf(line, "search %d %d %d %d %d", &a, &b, &c, &d, &e) == 5 && searchable_count < SEARCHABLE_COUNT)
+    {
+      valid = is_level_pos(a, b) && is_level_item_type(c) && is_level_item_type(d) && is_level_item_type(e);
+      
+      searchable_t *searchable = &level->searchables[searchable_count++];
+      searchable->x = a;
+      searchable->y = b;
+      searchable->loot[0] = (item_e)c;
+      searchable->loot[1] = (item_e)d;
+      searchable->loot[2] = (item_e)e;
+    }
+    else
+    {
+      valid = false;
+    }
+  }
+  
+  fclose(file);
+  
+  valid = valid && row_count == ROOM_HEIGHT && has_start && has_exit &&
+    item_count == LEVEL_ITEM_COUNT && searchable_count == SEARCHABLE_COUNT;
+  
+  // A fire can only change as many tiles as the room has room for
+  if(valid)
+  {
+    i32 wood_count = 0;
+    for(i32 y = 0; y < ROOM_HEIGHT; y++)
+    {
+      for(i32 x = 0; x < ROOM_WIDTH; x++)
+      {
+        wood_count += is_burnable(level->room[y][x]);
+      }
+    }
+    
+    // All of the level's items have to fit at once
+    i32 level_item_count = LEVEL_ITEM_COUNT;
+    for(i32 i = 0; i < SEARCHABLE_COUNT; i++)
+    {
+      for(i32 loot_i = 0; loot_i < LOOT_COUNT; loot_i++)
+      {
+        level_item_count += (level->searchables[i].loot[loot_i] != item_none);
+      }
+    }
+    
+    valid = (wood_count <= LEVEL_MAX_WOOD) &&
+      (level_item_count <= ITEM_COUNT) &&
+      is_walkable(level->room[level->start_y][level->start_x]) &&
+      level->room[level->exit_y][STONE_DOOR_X] == glyph_stone_door &&
+      level->room[level->exit_y][WOODEN_DOOR_X] == glyph_wooden_door;
+  }
+  
+  return valid;
+}
+
+// How many of each item can still be had
+internal void
+get_item_supply(rebirth_ctx_t *ctx, u8 *supply)
+{
+  memset(supply, 0, item_count);
+  
+  for(i32 i = 0; i < ITEM_COUNT * 2; i++)
+  {
+    item_t *item = (i < ITEM_COUNT) ? &ctx->items[i] : &ctx->player.inventory[i - ITEM_COUNT];
+    if((i < ITEM_COUNT) ? item->active : item->in_inventory)
+    {
+      if(item->type == item_bunsen_burner)
+      {
+        supply[item->type] += (u8)(item->max_use_count - item->use_count);
+      }
+      else
+      {
+        supply[item->type]++;
+      }
+    }
+  }
+  
+  for(i32 i = 0; i < SEARCHABLE_COUNT; i++)
+  {
+    if(!is_searched(ctx, i))
+    {
+      for(i32 loot_i = 0; loot_i < LOOT_COUNT; loot_i++)
+      {
+        supply[ctx->level->searchables[i].loot[loot_i]]++;
+      }
+    }
+  }
+  
+  supply[item_none] = 0;
+}
+
+// Items the steps left use up and leave behind
+internal void
+get_item_demand(rebirth_ctx_t *ctx, item_e type, i32 *used_up, i32 *made, b32 *at_hand)
+{
+  *used_up = 0;
+  *made = 0;
+  *at_hand = false;
+  
+  for(u32 i = 0; i < array_count(escape_steps); i++)
+  {
+    escape_step_t *step = &escape_steps[i];
+    if(!is_puzzle_flag_set(ctx, step->flag))
+    {
+      *used_up += (step->used_up == type);
+      *made += (step->makes == type);
+      *at_hand |= (step->tools[0] == type || step->tools[1] == type);
+      
+      if(type == item_bunsen_burner)
+      {
+        *used_up += step->burner_uses;
+      }
+    }
+  }
+}
+
+internal b32
+is_item_need_met(rebirth_ctx_t *ctx, item_e type, u8 *supply)
+{
+  i32 used_up;
+  i32 made;
+  b32 at_hand;
+  get_item_demand(ctx, type, &used_up, &made, &at_hand);
+  
+  i32 available = supply[type] + made;
+  for(u32 i = 0; i < array_count(escape_recipes); i++)
+  {
+    escape_recipe_t *recipe = &escape_recipes[i];
+    if(recipe->makes == type)
+    {
+      // Whatever it's made from and with pays for it
+      available += supply[recipe->from];
+    }
+    else if(recipe->from == type || type == item_bunsen_burner)
+    {
+      i32 made_used_up;
+      i32 made_made;
+      b32 made_at_hand;
+      get_item_demand(ctx, recipe->makes, &made_used_up, &made_made, &made_at_hand);
+      
+      i32 shortfall = made_used_up - (supply[recipe->makes] + made_made);
+      if(shortfall > 0)
+      {
+        used_up += (recipe->from == type) ? shortfall : shortfall * recipe->burner_uses;
+      }
+    }
+  }
+  
+  if(at_hand && !used_up)
+  {
+    used_up = 1;
+  }
+  
+  return available >= used_up;
+}
+
+// Check every item
+shared b32
+is_game_winnable(rebirth_ctx_t *ctx)
+{
+  u8 supply[item_count];
+  get_item_supply(ctx, supply);
+  
+  for(i32 type = item_none + 1; type < item_count; type++)
+  {
+    if(!is_item_need_met(ctx, (item_e)type, supply))
+    {
+      return false;
+    }
+  }
+  
+  return true;
+}
+
+// What each item's need depends on
+internal void
+init_soft_lock(rebirth_ctx_t *ctx)
+{
+  memset(&ctx->soft_lock, 0, sizeof(ctx->soft_lock));
+  
+  for(i32 type = item_none + 1; type < item_count; type++)
+  {
+    u32 dependencies = (u32)1 << type;
+    for(u32 i = 0; i < array_count(escape_recipes); i++)
+    {
+      escape_recipe_t *recipe = &escape_recipes[i];
+      if((i32)recipe->makes == type || (i32)recipe->from == type || type == item_bunsen_burner)
+      {
+        dependencies |= ((u32)1 << recipe->makes) | ((u32)1 << recipe->from) | ((u32)1 << item_bunsen_burner);
+      }
+    }
+    
+    u16 flag_dependencies = 0;
+    for(u32 i = 0; i < array_count(escape_steps); i++)
+    {
+      escape_step_t *step = &escape_steps[i];
+      u32 step_items = ((u32)1 << step->used_up) | ((u32)1 << step->makes) |
+        ((u32)1 << step->tools[0]) | ((u32)1 << step->tools[1]);
+      
+      if((step_items & dependencies & ~(u32)1) ||
+         (step->burner_uses && (dependencies & ((u32)1 << item_bunsen_burner))))
+      {
+        flag_dependencies |= (u16)(1 << step->flag);
+      }
+    }
+    
+    ctx->soft_lock.item_dependencies[type] = dependencies;
+    ctx->soft_lock.flag_dependencies[type] = flag_dependencies;
+  }
+  
+  get_item_supply(ctx, ctx->soft_lock.supply);
+  ctx->soft_lock.puzzle = ctx->game.puzzle;
+  
+  for(i32 type = item_none + 1; type < item_count; type++)
+  {
+    if(!is_item_need_met(ctx, (item_e)type, ctx->soft_lock.supply))
+    {
+      ctx->soft_lock.unmet |= (u32)1 << type;
+    }
+  }
+  
+  save_game(ctx, &ctx->soft_lock.last_winnable);
+}
+
+// Called after every turn
+internal void
+update_soft_lock(rebirth_ctx_t *ctx)
+{
+  u8 supply[item_count];
+  get_item_supply(ctx, supply);
+  
+  u32 changed_items = 0;
+  for(i32 type = item_none + 1; type < item_count; type++)
+  {
+    if(supply[type] != ctx->soft_lock.supply[type])
+    {
+      changed_items |= (u32)1 << type;
+    }
+  }
+  
+  u16 changed_flags = ctx->game.puzzle ^ ctx->soft_lock.puzzle;
+  if(changed_items || changed_flags)
+  {
+    for(i32 type = item_none + 1; type < item_count; type++)
+    {
+      if((ctx->soft_lock.item_dependencies[type] & changed_items) ||
+         (ctx->soft_lock.flag_dependencies[type] & changed_flags))
+      {
+        if(is_item_need_met(ctx, (item_e)type, supply))
+        {
+          ctx->soft_lock.unmet &= ~((u32)1 << type);
+        }
+        else
+        {
+          ctx->soft_lock.unmet |= (u32)1 << type;
+        }
+      }
+    }
+    
+    memcpy(ctx->soft_lock.supply, supply, sizeof(supply));
+    ctx->soft_lock.puzzle = ctx->game.puzzle;
+  }
+  
+  if(ctx->soft_lock.unmet)
+  {
+    ctx->soft_lock.lost = true;
+  }
+  else
+  {
+    ctx->soft_lock.lost = false;
+    save_game(ctx, &ctx->soft_lock.last_winnable);
+  }
+}
+
+internal void
+restore_last_winnable_state(rebirth_ctx_t *ctx)
+{
+  load_game(ctx, &ctx->soft_lock.last_winnable);
+  get_item_supply(ctx, ctx->soft_lock.supply);
+  ctx->soft_lock.puzzle = ctx->game.puzzle;
+  ctx->soft_lock.unmet = 0;
+  ctx->soft_lock.lost = false;
+  
+  push_message(ctx, "You blink and find yourself back where you were before it all went wrong.");
+}
+
+internal void
+move_menu_option_selected_up(rebirth_ctx_t *ctx)
+{
+  if((ctx->game.menu_option_selected - 1) >= 1)
+  {
+    ctx->game.menu_option_selected--;
+  }
+}
+
+internal void
+move_menu_option_selected_down(rebirth_ctx_t *ctx)
+{
+  if((ctx->game.menu_option_selected + 1) <= ctx->game.menu_option_count)
+  {
+    ctx->game.menu_option_selected++;
+  }
+}
+
+// Take the game one input further
+shared game_output_t
+step_game(rebirth_ctx_t *ctx, i32 input)
+{
+  game_output_t output = {0};
+  if(input == input_none)
+  {
+    return output;
+  }
+  
+  game_state_e old_state = ctx->game.state;
+  
+  switch(ctx->game.state)
+  {
+    case state_main_menu:
+    {
+      if(input == input_enter)
+      {
+        if(ctx->game.menu_option_selected == 1)
+        {
+          ctx->game.state = state_intro;
+        }
+        else if(ctx->game.menu_option_selected == 2)
+        {
+          ctx->game.state = state_controls;
+        }
+        else
+        {
+          ctx->game.state = state_quit;
+        }
+      }
+      else if(input == input_up)
+      {
+        move_menu_option_selected_up(ctx);
+      }
+      else if(input == input_down)
+      {
+        move_menu_option_selected_down(ctx);
+      }
+    } break;
+    
+    case state_controls:
+    {
+      if(input == input_enter)
+      {
+        ctx->game.state = state_main_menu;
+      }
+    } break;
+    
+    case state_intro:
+    {
+      if(input == input_enter)
+      {
+        ctx->game.paragraph++;
+      }
+      
+      if(ctx->game.paragraph == INTRO_PARAGRAPH_COUNT || input == 's')
+      {
+        init_soft_lock(ctx);
+        ctx->game.state = state_play;
+      }
+    } break;
+    
+    case state_play:
+    {
+      // The slot and travel choice prompts take any key as their answer
+      b32 answering = (ctx->player.prompt == prompt_use_slot ||
+                       ctx->player.prompt == prompt_travel_choice);
+      
+      if(input == 'r' && ctx->soft_lock.lost && !answering)
+      {
+        restore_last_winnable_state(ctx);
+      }
+      else if(input == 'h' && !answering)
+      {
+        ctx->game.message[0] = 0;
+        output.hint_asked = true;
+      }
+      else
+      {
+        update_game(ctx, input);
+        
+        if(ctx->game.state == state_play)
+        {
+          update_soft_lock(ctx);
+        }
+      }
+    } break;
+    
+    case state_outro:
+    {
+      if(input == input_enter)
+      {
+        ctx->game.paragraph++;
+      }
+      
+      if(ctx->game.paragraph == OUTRO_PARAGRAPH_COUNT || input == 's')
+      {
+        init_game_data(ctx);
+        ctx->game.state = state_main_menu;
+      }
+    } break;
+    
+    default: break;
+  }
+  
+  if(ctx->game.state == state_play)
+  {
+    trace_begin("update_light");
+    update_light(ctx);
+    trace_end();
+  }
+  
+  if(ctx->game.state != old_state)
+  {
+    ctx->game.paragraph = 0;
+    output.state_changed = true;
+  }
+  
+  return output;
+}
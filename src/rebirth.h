@@ -0,0 +1,550 @@
+#if !defined(REBIRTH_H)
+
+#include <stdio.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdarg.h>
+
+#define internal static
+#define global static
+
+// For what only some of the programs built from these files call
+#define shared static __attribute__((unused))
+
+#define array_count(array) (sizeof(array) / sizeof((array)[0]))
+
+typedef int8_t i8;
+typedef int16_t i16;
+typedef int32_t i32;
+typedef int64_t i64;
+
+typedef uint8_t u8;
+typedef uint16_t u16;
+typedef uint32_t u32;
+typedef uint64_t u64;
+
+typedef float r32;
+typedef double r64;
+
+typedef u32 b32;
+
+// Report out of bounds indexes
+#if REBIRTH_CHECKED
+internal void report_bad_index(char *expression, i32 index, i32 line);
+#define check_index(index, count) if((index) < 0 || (index) >= (count)) {report_bad_index(#index, (index), __LINE__);}
+#else
+#define check_index(index, count)
+#endif
+
+// Time the parts of a frame
+#if REBIRTH_TRACE
+internal void begin_trace_span(char *name);
+internal void end_trace_span();
+#define trace_begin(name) begin_trace_span(name)
+#define trace_end() end_trace_span()
+#else
+#define trace_begin(name)
+#define trace_end()
+#endif
+
+#define ROOM_WIDTH 24
+#define ROOM_HEIGHT 10
+
+#define MAX_LENGTH 256
+#define GENERAL_LENGTH 32
+
+#define ITEM_COUNT 20
+#define SEARCHABLE_COUNT 11
+#define LOOT_COUNT 3
+
+#define ASCII_LOWERCASE_START 96
+
+#define INTRO_PARAGRAPH_COUNT 3
+#define OUTRO_PARAGRAPH_COUNT 6
+
+#define ROOM_TILE_WORDS (((ROOM_WIDTH * ROOM_HEIGHT) + 31) / 32)
+
+// Bit x for column x
+#define ROOM_ROW_MASK (((u32)1 << ROOM_WIDTH) - 1)
+#define STATE_CODE_ASH_WORDS ROOM_TILE_WORDS
+#define PACKED_GAME_SIZE 256
+
+// Doors and wood
+#define LEVEL_MAX_WOOD 31
+#define ROOM_CHANGE_COUNT 40
+
+#define LEVEL_ITEM_COUNT 3
+
+// Doors out, on the exit row
+#define STONE_DOOR_X (ROOM_WIDTH - 3)
+#define WOODEN_DOOR_X (ROOM_WIDTH - 1)
+
+// Burn turns left, low and high bit
+#define FIRE_PLANE_COUNT 2
+
+// Event wheel
+#define EVENT_WHEEL_SLOTS 8
+#define EVENT_MAX_TURNS (EVENT_WHEEL_SLOTS * (EVENT_WHEEL_SLOTS - 1))
+
+// Line of sight and player light come first
+#define LIGHT_SOURCE_COUNT 8
+#define SIGHT_RADIUS (ROOM_WIDTH + ROOM_HEIGHT)
+#define TORCH_LIGHT_RADIUS 10
+#define PLAYER_LIGHT_RADIUS 1
+#define CARRIED_LIGHT_RADIUS 3
+
+// Travel targets
+#define TRAVEL_FIELD_COUNT 16
+#define TRAVEL_CHOICE_COUNT 5
+#define TRAVEL_UNREACHABLE 0xFF
+
+enum
+{
+  glyph_blank = ' ',
+  glyph_stone = '#',
+  glyph_floor = '.',
+  glyph_bookshelf = 'B',
+  glyph_crate = 'X',
+  glyph_small_crate = 'x',
+  glyph_stone_door = '|',
+  glyph_stone_door_open = '_',
+  glyph_wooden_door = '+',
+  glyph_wooden_door_open = '/',
+  glyph_open_chest = 'C',
+  glyph_table = 'T',
+  glyph_chair = 'L',
+  glyph_torch = 'i',
+  glyph_vial = '!',
+  glyph_tin = '}',
+  glyph_magnet = ']',
+  glyph_chain = '~',
+  glyph_knife = 'I',
+  glyph_metal_spade = 'S',
+  glyph_metal_spade_no_handle = 's',
+  glyph_bunsen_burner = '^',
+  glyph_bronze_key = '=',
+  glyph_ash = ','
+} glyph_e;
+
+typedef enum
+{
+  item_none,
+  item_metal_spade,
+  item_metal_spade_no_handle,
+  item_knife,
+  item_empty_vial,
+  item_dihydrogen_monoxide,
+  item_cupric_ore_powder,
+  item_tin_ore_powder,
+  item_tin,
+  item_sodium_chloride,
+  item_gypsum,
+  item_cupric_sulfate,
+  item_acetic_acid,
+  item_magnet,
+  item_bunsen_burner,
+  item_bronze_key,
+  item_count
+} item_e;
+
+typedef enum
+{
+  state_main_menu,
+  state_intro,
+  state_play,
+  state_controls,
+  state_quit,
+  state_outro
+} game_state_e;
+
+typedef enum
+{
+  error_none,
+  error_no_color_support,
+  error_no_key_file,
+  error_no_spectate_socket,
+  error_no_level_file,
+  error_no_play_log
+} game_error_e;
+
+// Events, at most eight
+typedef enum
+{
+  event_none,
+  event_blackout,
+  event_blackout_end,
+  event_fire,
+  
+  event_kind_count
+} game_event_e;
+
+// Keys without a character
+enum
+{
+  input_none = 0,
+  input_enter = 10,
+  input_up = 0x100,
+  input_down
+} game_input_e;
+
+// Prompts answered by the next key
+typedef enum
+{
+  prompt_none,
+  prompt_use_direction,
+  prompt_use_slot,
+  prompt_pick_up_direction,
+  prompt_interact_direction,
+  prompt_inspect_direction,
+  prompt_travel_target,
+  prompt_travel_choice
+} prompt_e;
+
+typedef enum
+{
+  puzzle_first_door_open,
+  puzzle_first_door_dihydrogen_monoxide_added,
+  puzzle_first_door_cupric_sulfate_added,
+  puzzle_first_door_spade_inserted,
+  
+  puzzle_second_door_open,
+  puzzle_second_door_key_inserted,
+  puzzle_second_door_key_pried,
+  puzzle_second_door_key_complete,
+  puzzle_second_door_tin_ore_powder_added,
+  puzzle_second_door_cupric_ore_powder_added,
+  puzzle_second_door_key_imprint_made,
+  puzzle_second_door_gypsum_added,
+  puzzle_second_door_dihydrogen_monoxide_added,
+  
+  puzzle_flag_count
+} puzzle_flag_e;
+
+typedef struct
+{
+  u8 pending;
+  u8 due_turn;
+} scheduled_event_t;
+
+typedef struct
+{
+  game_error_e error;
+  
+  game_state_e state;
+  
+  // The turn the wheel is at and the events waiting on it, every kind of
+  // event is waiting at most once.
+  u8 event_turn;
+  u8 event_wheel[2][EVENT_WHEEL_SLOTS];
+  scheduled_event_t events[event_kind_count];
+  
+  // What the events leave the room looking like, the renderers only read this
+  b32 dark;
+  
+  // The fire is stepped from the front buffer into the back one and the two
+  // are swapped, what's left in the back buffer is never read.
+  u32 fire[2][FIRE_PLANE_COUNT][ROOM_HEIGHT];
+  u8 fire_front;
+  
+  i32 menu_option_selected;
+  i32 menu_option_count;
+  
+  // How far the intro or the outro has been read
+  i32 paragraph;
+  
+  // One bit per puzzle_flag_e
+  u16 puzzle;
+  
+  // Set by the rules during a turn, drawn by the platform layer
+  char message[MAX_LENGTH];
+} game_t;
+
+// What a step leaves to the caller
+typedef struct
+{
+  b32 state_changed;
+  b32 hint_asked;
+} game_output_t;
+
+typedef struct
+{
+  b32 active;
+  b32 in_inventory;
+  item_e type;
+  char name[GENERAL_LENGTH];
+  i32 id;
+  i32 x;
+  i32 y;
+  i32 use_count;
+  i32 max_use_count;
+  char glyph;
+} item_t;
+
+typedef struct
+{
+  i32 x;
+  i32 y;
+  i32 turn;
+  i32 input;
+  
+  prompt_e prompt;
+  i32 use_x;
+  i32 use_y;
+  i32 travel_key;
+  
+  item_t inventory[ITEM_COUNT];
+  b32 inventory_enabled;
+  i32 inventory_item_selected;
+  i32 inventory_item_count;
+  
+  i32 inventory_first_combination_item_num;
+  i32 inventory_second_combination_item_num;
+  item_e inventory_first_combination_item;
+  item_e inventory_second_combination_item;
+} player_t;
+
+// Searched searchables
+typedef struct
+{
+  i32 x;
+  i32 y;
+  item_e loot[LOOT_COUNT];
+} searchable_t;
+
+typedef struct
+{
+  i32 x;
+  i32 y;
+  item_e type;
+  i32 max_use_count;
+} level_item_t;
+
+// Shared by every game, read only
+typedef struct
+{
+  u8 room[ROOM_HEIGHT][ROOM_WIDTH + 1];
+  level_item_t items[LEVEL_ITEM_COUNT];
+  searchable_t searchables[SEARCHABLE_COUNT];
+  
+  i32 start_x;
+  i32 start_y;
+  i32 exit_y;
+} level_t;
+
+typedef struct
+{
+  u8 tile;
+  u8 glyph;
+} tile_change_t;
+
+// Tiles changed from the level, sorted by tile
+typedef struct
+{
+  u32 changed[ROOM_TILE_WORDS];
+  u32 change_count;
+  tile_change_t changes[ROOM_CHANGE_COUNT];
+  
+  u32 traversable[ROOM_HEIGHT];
+  u32 opaque[ROOM_HEIGHT];
+  u32 burnable[ROOM_HEIGHT];
+} room_t;
+
+// Equal for states that play the same
+typedef struct
+{
+  u32 ash[STATE_CODE_ASH_WORDS];   // One bit per tile that has burned or is going to
+  u16 puzzle;                      // game_t.puzzle
+  u16 searched;                    // One bit per searchable
+  u16 floor_items[ITEM_COUNT];     // (type << 8) | tile, sorted ascending
+  u8 player_x;
+  u8 player_y;
+  u8 floor_item_count;
+  u8 unused;
+  u8 inventory[item_count / 2];    // Item count per item type, 4 bits each
+  u8 use_counts[item_count / 2];   // Use count per item type, 4 bits each
+} state_code_t;
+
+// Exact game in as few bits as possible
+typedef struct
+{
+  u8 bits[PACKED_GAME_SIZE];
+} packed_game_t;
+
+typedef struct
+{
+  u8 *bits;
+  u32 at;
+} bit_cursor_t;
+
+typedef struct
+{
+  game_t game;
+  player_t player;
+  room_t room;
+  item_t items[ITEM_COUNT];
+  u16 searched;
+} game_snapshot_t;
+
+// Shared with rebirth-inspect, sequence is odd while writing
+#define INSPECT_NAME_FORMAT "/rebirth-%d"
+#define INSPECT_VERSION 1
+
+typedef struct
+{
+  u32 version;
+  u32 sequence;
+  u32 frame;
+  level_t level;
+  game_snapshot_t snapshot;
+} inspect_region_t;
+
+typedef struct
+{
+  i32 count;
+  i32 at;
+  u8 *keys;
+} key_sequence_t;
+
+// Step on the way out
+typedef struct
+{
+  puzzle_flag_e flag;
+  item_e used_up;
+  item_e tools[2];
+  i32 burner_uses;
+  item_e makes;
+} escape_step_t;
+
+// Item that can be made from another
+typedef struct
+{
+  item_e makes;
+  item_e from;
+  i32 burner_uses;
+} escape_recipe_t;
+
+typedef struct
+{
+  // Which item counts and puzzle flags the need for each item type depends
+  // on, worked out from the steps once
+  u32 item_dependencies[item_count];
+  u16 flag_dependencies[item_count];
+  
+  // What the last check saw, the bunsen burner counts its uses left
+  u8 supply[item_count];
+  u16 puzzle;
+  
+  // One bit per item type that can't be had as many times as it's needed
+  u32 unmet;
+  
+  b32 lost;
+  game_snapshot_t last_winnable;
+} soft_lock_t;
+
+// Tiles a source reaches
+typedef struct
+{
+  i32 x;
+  i32 y;
+  i32 radius;
+  b32 stale;
+  u32 lit[ROOM_TILE_WORDS];
+} light_source_t;
+
+// Not saved or packed
+typedef struct
+{
+  u32 source_count;
+  light_source_t sources[LIGHT_SOURCE_COUNT];
+  
+  // In the player's line of sight and lit by something
+  u32 visible[ROOM_TILE_WORDS];
+} light_t;
+
+// Steps to stand next to the target
+typedef struct
+{
+  u8 target;
+  u8 distance[ROOM_WIDTH][ROOM_HEIGHT];
+} travel_field_t;
+
+// Not saved or packed
+typedef struct
+{
+  u32 field_count;
+  u32 next_replaced;
+  travel_field_t fields[TRAVEL_FIELD_COUNT];
+} travel_t;
+
+// Power of two
+#define PLAY_LOG_SIZE 4096
+
+typedef enum
+{
+  play_key,
+  play_use,
+  play_combine,
+  play_interact,
+  play_pick_up,
+  play_puzzle,
+  play_message
+} play_event_e;
+
+// Logged event
+typedef struct
+{
+  u16 turn;
+  u8 kind;
+  u8 key;
+  u8 x;
+  u8 y;
+  u8 first_item;
+  u8 second_item;
+  u16 puzzle;
+  u16 unused;
+  u32 detail;
+} play_event_t;
+
+// One writer and one reader, full drops the event
+typedef struct
+{
+  // Written by the game
+  u32 head __attribute__((aligned(64)));
+  u32 dropped;
+  
+  // Written by the thread taking the events
+  u32 tail __attribute__((aligned(64)));
+  
+  play_event_t events[PLAY_LOG_SIZE];
+} play_log_t;
+
+// Everything one game is made of
+typedef struct
+{
+  // The level the game is played in, the one the game comes with unless
+  // it's set before the game is first set up
+  level_t *level;
+  
+  // Where what's played is logged to, if anywhere
+  play_log_t *play_log;
+  
+  game_t game;
+  player_t player;
+  room_t room;
+  item_t items[ITEM_COUNT];
+  
+  // One bit per searchable that has been searched
+  u16 searched;
+  
+  // One bit per tile the player has seen, going back doesn't forget them
+  u32 seen[ROOM_TILE_WORDS];
+  
+  soft_lock_t soft_lock;
+  light_t light;
+  travel_t travel;
+} rebirth_ctx_t;
+
+#define REBIRTH_H
+#endif
@@ -0,0 +1,413 @@
+#include "rebirth.c"
+#include "rebirth_render.c"
+
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_HAS_CYCLES 1
+#else
+#define BENCH_HAS_CYCLES 0
+#endif
+
+#define BENCH_DEFAULT_RUNS 21
+#define BENCH_MAX_RUNS 255
+
+// Shortest run
+#define BENCH_RUN_NS 2000000
+
+typedef struct
+{
+  rebirth_ctx_t *ctx;
+  game_snapshot_t start;
+  screen_t *screen;
+
+  // The first door, which every item can be used on
+  i32 door_x;
+  i32 door_y;
+} bench_t;
+
+typedef u64 bench_function_t(bench_t *bench, u32 count);
+
+typedef struct
+{
+  char *name;
+  bench_function_t *function;
+
+  // Puts the game back the way it started after every op, which is timed
+  // along with it. The load_game row is what that costs.
+  b32 loads_game;
+} bench_case_t;
+
+typedef struct
+{
+  u32 count;
+  r64 ns_min;
+  r64 ns_median;
+  r64 cycles_min;
+} bench_result_t;
+
+// Keeps the calls from being optimized out
+global volatile u64 bench_sink;
+
+internal u64
+get_bench_ns()
+{
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return ((u64)time.tv_sec * 1000000000) + (u64)time.tv_nsec;
+}
+
+// Reference cycles
+internal u64
+get_bench_cycles()
+{
+#if BENCH_HAS_CYCLES
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+internal u64
+bench_is_traversable(bench_t *bench, u32 count)
+{
+  u64 result = 0;
+  for(u32 i = 0; i < count; i++)
+  {
+    i32 tile = i % (ROOM_WIDTH * ROOM_HEIGHT);
+    result += is_traversable(bench->ctx, tile % ROOM_WIDTH, tile / ROOM_WIDTH);
+  }
+
+  return result;
+}
+
+internal u64
+bench_is_item_pos(bench_t *bench, u32 count)
+{
+  u64 result = 0;
+  for(u32 i = 0; i < count; i++)
+  {
+    i32 tile = i % (ROOM_WIDTH * ROOM_HEIGHT);
+    result += is_item_pos(bench->ctx, tile % ROOM_WIDTH, tile / ROOM_WIDTH);
+  }
+
+  return result;
+}
+
+internal u64
+bench_get_item_type_for_pos(bench_t *bench, u32 count)
+{
+  u64 result = 0;
+  for(u32 i = 0; i < count; i++)
+  {
+    i32 tile = i % (ROOM_WIDTH * ROOM_HEIGHT);
+    result += get_item_type_for_pos(bench->ctx, tile % ROOM_WIDTH, tile / ROOM_WIDTH);
+  }
+
+  return result;
+}
+
+// Take the item back out
+internal u64
+bench_add_item(bench_t *bench, u32 count)
+{
+  rebirth_ctx_t *ctx = bench->ctx;
+
+  u64 result = 0;
+  for(u32 i = 0; i < count; i++)
+  {
+    i32 id = add_item(ctx, i % ROOM_WIDTH, 1, item_tin, 0);
+    i32 slot = get_item_pos_for_id(ctx, id);
+    memset(&ctx->items[slot], 0, sizeof(item_t));
+    result += id;
+  }
+
+  return result;
+}
+
+internal u64
+bench_load_game(bench_t *bench, u32 count)
+{
+  u64 result = 0;
+  for(u32 i = 0; i < count; i++)
+  {
+    load_game(bench->ctx, &bench->start);
+    result += bench->ctx->player.inventory_item_count;
+  }
+
+  return result;
+}
+
+internal u64
+bench_remove_inventory_item(bench_t *bench, u32 count)
+{
+  rebirth_ctx_t *ctx = bench->ctx;
+
+  u64 result = 0;
+  for(u32 i = 0; i < count; i++)
+  {
+    remove_inventory_item(ctx, 1 + (i % ctx->player.inventory_item_count));
+    result += ctx->player.inventory[0].type;
+    load_game(ctx, &bench->start);
+  }
+
+  return result;
+}
+
+internal u64
+bench_drop_inventory_item(bench_t *bench, u32 count)
+{
+  rebirth_ctx_t *ctx = bench->ctx;
+
+  u64 result = 0;
+  for(u32 i = 0; i < count; i++)
+  {
+    drop_inventory_item(ctx, ctx->player.x, ctx->player.y, 1 + (i % ctx->player.inventory_item_count));
+    result += ctx->player.inventory[0].type;
+    load_game(ctx, &bench->start);
+  }
+
+  return result;
+}
+
+// Burn the handle off the spade
+internal u64
+bench_combine(bench_t *bench, u32 count)
+{
+  rebirth_ctx_t *ctx = bench->ctx;
+
+  u64 result = 0;
+  for(u32 i = 0; i < count; i++)
+  {
+    combine(ctx, ctx->player.inventory_first_combination_item,
+            ctx->player.inventory_second_combination_item);
+    result += ctx->player.inventory[0].type;
+    load_game(ctx, &bench->start);
+  }
+
+  return result;
+}
+
+// Use every item on the door
+internal u64
+bench_use_item(bench_t *bench, u32 count)
+{
+  rebirth_ctx_t *ctx = bench->ctx;
+
+  u64 result = 0;
+  for(u32 i = 0; i < count; i++)
+  {
+    use_item(ctx, bench->door_x, bench->door_y, 1 + (i % ctx->player.inventory_item_count));
+    result += ctx->game.puzzle;
+    load_game(ctx, &bench->start);
+  }
+
+  return result;
+}
+
+internal u64
+bench_render_room(bench_t *bench, u32 count)
+{
+  u64 result = 0;
+  for(u32 i = 0; i < count; i++)
+  {
+    render_room(bench->screen, bench->ctx);
+    result += bench->screen->cells[i % ROOM_HEIGHT][i % ROOM_WIDTH].glyph;
+  }
+
+  return result;
+}
+
+internal u64
+bench_init_game_data(bench_t *bench, u32 count)
+{
+  u64 result = 0;
+  for(u32 i = 0; i < count; i++)
+  {
+    init_game_data(bench->ctx);
+    result += bench->ctx->items[0].id;
+  }
+
+  return result;
+}
+
+global bench_case_t bench_cases[] =
+{
+  {"is_traversable", bench_is_traversable, false},
+  {"is_item_pos", bench_is_item_pos, false},
+  {"get_item_type_for_pos", bench_get_item_type_for_pos, false},
+  {"add_item", bench_add_item, false},
+  {"load_game", bench_load_game, false},
+  {"remove_inventory_item", bench_remove_inventory_item, true},
+  {"drop_inventory_item", bench_drop_inventory_item, true},
+  {"combine", bench_combine, true},
+  {"use_item", bench_use_item, true},
+  {"render_room", bench_render_room, false},
+  {"init_game_data", bench_init_game_data, false}
+};
+
+// Search and pick up everything
+internal void
+init_bench_game(bench_t *bench)
+{
+  rebirth_ctx_t *ctx = bench->ctx;
+  init_game_data(ctx);
+  ctx->game.state = state_play;
+
+  for(i32 i = 0; i < SEARCHABLE_COUNT; i++)
+  {
+    add_searchable_loot(ctx, ctx->level->searchables[i].x, ctx->level->searchables[i].y);
+  }
+
+  for(i32 i = 0; i < LEVEL_ITEM_COUNT; i++)
+  {
+    pick_up(ctx, ctx->level->items[i].x, ctx->level->items[i].y);
+  }
+
+  update_inventory_item_count(ctx);
+  ctx->player.inventory_enabled = true;
+  ctx->player.inventory_item_selected = 1;
+
+  ctx->player.inventory_first_combination_item_num = get_inventory_position_for_item_type(ctx, item_metal_spade) + 1;
+  ctx->player.inventory_second_combination_item_num = get_inventory_position_for_item_type(ctx, item_bunsen_burner) + 1;
+  ctx->player.inventory_first_combination_item = item_metal_spade;
+  ctx->player.inventory_second_combination_item = item_bunsen_burner;
+
+  bench->door_x = STONE_DOOR_X;
+  bench->door_y = ctx->level->exit_y;
+
+  save_game(ctx, &bench->start);
+  update_light(ctx);
+  clear_screen(bench->screen);
+}
+
+internal int
+compare_r64(const void *a, const void *b)
+{
+  r64 first = *(r64 *)a;
+  r64 second = *(r64 *)b;
+  return (first > second) - (first < second);
+}
+
+// Double the ops until a run is long enough, keep the fastest
+internal bench_result_t
+run_bench_case(bench_t *bench, bench_case_t *bench_case, u32 run_count)
+{
+  bench_result_t result = {0};
+  load_game(bench->ctx, &bench->start);
+  update_light(bench->ctx);
+
+  u32 count = 1;
+  for(;;)
+  {
+    u64 start = get_bench_ns();
+    bench_sink += bench_case->function(bench, count);
+    if(get_bench_ns() - start >= BENCH_RUN_NS || count >= (1u << 30))
+    {
+      break;
+    }
+
+    count *= 2;
+  }
+
+  r64 ns[BENCH_MAX_RUNS];
+  r64 cycles_min = 0;
+  for(u32 run = 0; run < run_count; run++)
+  {
+    load_game(bench->ctx, &bench->start);
+    update_light(bench->ctx);
+
+    u64 start_cycles = get_bench_cycles();
+    u64 start = get_bench_ns();
+    bench_sink += bench_case->function(bench, count);
+    u64 end = get_bench_ns();
+    u64 end_cycles = get_bench_cycles();
+
+    ns[run] = (r64)(end - start) / count;
+    r64 cycles = (r64)(end_cycles - start_cycles) / count;
+    cycles_min = (!run || cycles < cycles_min) ? cycles : cycles_min;
+  }
+
+  qsort(ns, run_count, sizeof(r64), compare_r64);
+
+  result.count = count;
+  result.ns_min = ns[0];
+  result.ns_median = ns[run_count / 2];
+  result.cycles_min = cycles_min;
+  return result;
+}
+
+i32
+main(i32 argc, char **argv)
+{
+  u32 run_count = BENCH_DEFAULT_RUNS;
+  b32 tsv = false;
+  char *only = 0;
+
+  for(i32 i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--runs") && (i + 1) < argc)
+    {
+      run_count = (u32)strtoul(argv[++i], 0, 10);
+    }
+    else if(!strcmp(argv[i], "--only") && (i + 1) < argc)
+    {
+      only = argv[++i];
+    }
+    else if(!strcmp(argv[i], "--tsv"))
+    {
+      tsv = true;
+    }
+    else
+    {
+      printf("Usage: %s [--runs count] [--only name] [--tsv]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  run_count = run_count < 1 ? 1 : run_count;
+  run_count = run_count > BENCH_MAX_RUNS ? BENCH_MAX_RUNS : run_count;
+
+  bench_t bench = {0};
+  bench.ctx = calloc(1, sizeof(rebirth_ctx_t));
+  bench.screen = calloc(1, sizeof(screen_t));
+  init_bench_game(&bench);
+
+  // Table or tab separated lines
+  if(tsv)
+  {
+    printf("name\tops\tns_min\tns_median\tcycles_min\tloads_game\n");
+  }
+  else
+  {
+    printf("%-24s %12s %12s %12s\n", "", "ns/op", "median", BENCH_HAS_CYCLES ? "cycles/op" : "");
+  }
+
+  for(u32 i = 0; i < array_count(bench_cases); i++)
+  {
+    bench_case_t *bench_case = &bench_cases[i];
+    if(only && strcmp(only, bench_case->name))
+    {
+      continue;
+    }
+
+    bench_result_t result = run_bench_case(&bench, bench_case, run_count);
+    if(tsv)
+    {
+      printf("%s\t%u\t%.2f\t%.2f\t%.1f\t%u\n", bench_case->name, result.count, result.ns_min,
+             result.ns_median, result.cycles_min, bench_case->loads_game);
+    }
+    else
+    {
+      printf("%-24s %12.2f %12.2f %12.1f%s\n", bench_case->name, result.ns_min, result.ns_median,
+             result.cycles_min, bench_case->loads_game ? "  (with load_game)" : "");
+    }
+
+    fflush(stdout);
+  }
+
+  free(bench.screen);
+  free(bench.ctx);
+  return EXIT_SUCCESS;
+}
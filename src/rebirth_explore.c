@@ -0,0 +1,692 @@
+#include "rebirth.c"
+#include "rebirth_search.c"
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+#define EXPLORE_DEFAULT_MAX_STATES (1 << 21)
+#define EXPLORE_MAX_THREADS 64
+#define EXPLORE_NO_NODE 0xFFFFFFFF
+
+typedef struct
+{
+  state_code_t code;
+
+  // The escape is in walking distance
+  b32 escapes;
+
+  // Lost a race to add the same state and was never handed out
+  b32 duplicate;
+
+  b32 winnable;
+} explore_node_t;
+
+typedef struct
+{
+  u32 from;
+  u32 to;
+  action_t action;
+  u8 glyph;
+} explore_edge_t;
+
+// Owner works the bottom, thieves the top
+typedef struct
+{
+  pthread_mutex_t lock;
+  u32 top;
+  u32 bottom;
+  u32 capacity;
+  u32 *nodes;
+} explore_deque_t;
+
+typedef struct explorer_t explorer_t;
+
+typedef struct
+{
+  explorer_t *explorer;
+  pthread_t thread;
+  rebirth_ctx_t ctx;
+  i32 index;
+  u32 random;
+
+  explore_deque_t deque;
+  search_expansion_t expansion;
+  u32 expanding_node;
+  u32 expanded_count;
+
+  u32 edge_count;
+  u32 edge_capacity;
+  explore_edge_t *edges;
+} explore_worker_t;
+
+struct explorer_t
+{
+  u32 max_nodes;
+  u32 node_count;
+  explore_node_t *nodes;
+
+  // (hash >> 32) << 32 | (node index + 1), zero means empty. Sized for the
+  // state budget up front so it never has to grow while being shared.
+  u64 *slots;
+  u32 slot_mask;
+
+  // Nodes added and not yet expanded, the work is done when it reaches zero
+  u32 pending_count;
+  b32 out_of_states;
+
+  i32 worker_count;
+  explore_worker_t workers[EXPLORE_MAX_THREADS];
+};
+
+internal void
+push_explore_deque(explore_deque_t *deque, u32 node_i)
+{
+  pthread_mutex_lock(&deque->lock);
+
+  if(deque->bottom == deque->capacity)
+  {
+    // Slide what's left down before growing
+    u32 count = deque->bottom - deque->top;
+    memmove(deque->nodes, deque->nodes + deque->top, count * sizeof(u32));
+    deque->top = 0;
+    deque->bottom = count;
+
+    if(!deque->capacity || count * 2 > deque->capacity)
+    {
+      deque->capacity = deque->capacity ? deque->capacity * 2 : 1024;
+      deque->nodes = realloc(deque->nodes, deque->capacity * sizeof(u32));
+    }
+  }
+
+  deque->nodes[deque->bottom++] = node_i;
+  pthread_mutex_unlock(&deque->lock);
+}
+
+internal b32
+pop_explore_deque(explore_deque_t *deque, u32 *node_i)
+{
+  b32 result = false;
+  pthread_mutex_lock(&deque->lock);
+
+  if(deque->bottom > deque->top)
+  {
+    *node_i = deque->nodes[--deque->bottom];
+    result = true;
+  }
+
+  pthread_mutex_unlock(&deque->lock);
+  return result;
+}
+
+// Steal the older half of another worker's queue
+internal b32
+steal_explore_work(explore_worker_t *worker, u32 *node_i)
+{
+  explorer_t *explorer = worker->explorer;
+
+  for(i32 attempt = 0; attempt < explorer->worker_count; attempt++)
+  {
+    worker->random ^= worker->random << 13;
+    worker->random ^= worker->random >> 17;
+    worker->random ^= worker->random << 5;
+
+    explore_worker_t *victim = &explorer->workers[worker->random % explorer->worker_count];
+    if(victim == worker)
+    {
+      continue;
+    }
+
+    u32 stolen[256];
+    u32 stolen_count = 0;
+
+    pthread_mutex_lock(&victim->deque.lock);
+    u32 count = victim->deque.bottom - victim->deque.top;
+    stolen_count = (count + 1) / 2;
+    stolen_count = stolen_count < array_count(stolen) ? stolen_count : array_count(stolen);
+    memcpy(stolen, victim->deque.nodes + victim->deque.top, stolen_count * sizeof(u32));
+    victim->deque.top += stolen_count;
+    pthread_mutex_unlock(&victim->deque.lock);
+
+    if(stolen_count)
+    {
+      for(u32 i = 1; i < stolen_count; i++)
+      {
+        push_explore_deque(&worker->deque, stolen[i]);
+      }
+
+      *node_i = stolen[0];
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Find or add the node for the code
+internal u32
+add_explore_node(explore_worker_t *worker, state_code_t *code, b32 *added)
+{
+  explorer_t *explorer = worker->explorer;
+  u64 hash = hash_state_code(code);
+  u32 slot = (u32)(hash >> 32) & explorer->slot_mask;
+  u32 new_node_i = EXPLORE_NO_NODE;
+
+  *added = false;
+
+  for(;;)
+  {
+    u64 entry = __atomic_load_n(&explorer->slots[slot], __ATOMIC_ACQUIRE);
+
+    if(!entry)
+    {
+      if(new_node_i == EXPLORE_NO_NODE)
+      {
+        new_node_i = __atomic_fetch_add(&explorer->node_count, 1, __ATOMIC_RELAXED);
+        if(new_node_i >= explorer->max_nodes)
+        {
+          __atomic_store_n(&explorer->out_of_states, true, __ATOMIC_RELAXED);
+          return EXPLORE_NO_NODE;
+        }
+
+        explore_node_t *node = &explorer->nodes[new_node_i];
+        memset(node, 0, sizeof(explore_node_t));
+        node->code = *code;
+      }
+
+      u64 new_entry = (hash & 0xFFFFFFFF00000000) | (new_node_i + 1);
+      if(__atomic_compare_exchange_n(&explorer->slots[slot], &entry, new_entry, false,
+                                     __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+      {
+        *added = true;
+        return new_node_i;
+      }
+    }
+
+    if((entry >> 32) == (hash >> 32) &&
+       are_state_codes_equal(&explorer->nodes[(u32)entry - 1].code, code))
+    {
+      if(new_node_i != EXPLORE_NO_NODE)
+      {
+        explorer->nodes[new_node_i].duplicate = true;
+      }
+
+      return (u32)entry - 1;
+    }
+
+    slot = (slot + 1) & explorer->slot_mask;
+  }
+}
+
+// Drop the player position and which furniture burned
+internal void
+canonicalize_state_code(rebirth_ctx_t *ctx, state_code_t *code)
+{
+  memset(code->ash, 0, sizeof(code->ash));
+
+  walk_field_t field;
+  build_walk_field(ctx, &field, ctx->player.x, ctx->player.y);
+
+  for(i32 tile = 0; tile < ROOM_WIDTH * ROOM_HEIGHT; tile++)
+  {
+    if(field.distance[tile % ROOM_WIDTH][tile / ROOM_WIDTH] != SEARCH_UNREACHABLE)
+    {
+      code->player_x = (u8)(tile % ROOM_WIDTH);
+      code->player_y = (u8)(tile / ROOM_WIDTH);
+      break;
+    }
+  }
+}
+
+internal void
+add_explore_child(rebirth_ctx_t *ctx, void *data, state_code_t *code, action_t action, u32 turns)
+{
+  (void)turns;
+
+  explore_worker_t *worker = (explore_worker_t *)data;
+  explorer_t *explorer = worker->explorer;
+
+  if(get_action_kind(action) == action_escape)
+  {
+    explorer->nodes[worker->expanding_node].escapes = true;
+    return;
+  }
+
+  state_code_t canonical = *code;
+  canonicalize_state_code(ctx, &canonical);
+
+  b32 added;
+  u32 node_i = add_explore_node(worker, &canonical, &added);
+  if(node_i == EXPLORE_NO_NODE || node_i == worker->expanding_node)
+  {
+    return;
+  }
+
+  if(added)
+  {
+    __atomic_fetch_add(&explorer->pending_count, 1, __ATOMIC_RELAXED);
+    push_explore_deque(&worker->deque, node_i);
+  }
+
+  u8 glyph = 0;
+  if(get_action_kind(action) != action_combine)
+  {
+    i32 direction = get_action_direction(action);
+    i32 target_x = get_action_x(action) + direction_x[direction];
+    i32 target_y = get_action_y(action) + direction_y[direction];
+    glyph = get_room_tile(worker->ctx.level, &worker->expansion.parent.room, target_x, target_y);
+  }
+
+  // Burning one chair or another ends up in the same state, one edge is enough
+  action_t kind_and_items = action & 0x7FE7;
+  if(worker->edge_count)
+  {
+    explore_edge_t *last = &worker->edges[worker->edge_count - 1];
+    if(last->from == worker->expanding_node && last->to == node_i &&
+       last->glyph == glyph && (last->action & 0x7FE7) == kind_and_items)
+    {
+      return;
+    }
+  }
+
+  if(worker->edge_count == worker->edge_capacity)
+  {
+    worker->edge_capacity = worker->edge_capacity ? worker->edge_capacity * 2 : 4096;
+    worker->edges = realloc(worker->edges, worker->edge_capacity * sizeof(explore_edge_t));
+  }
+
+  explore_edge_t *edge = &worker->edges[worker->edge_count++];
+  edge->from = worker->expanding_node;
+  edge->to = node_i;
+  edge->action = action;
+  edge->glyph = glyph;
+}
+
+internal void *
+run_explore_worker(void *data)
+{
+  explore_worker_t *worker = (explore_worker_t *)data;
+  explorer_t *explorer = worker->explorer;
+  rebirth_ctx_t *ctx = &worker->ctx;
+
+  worker->expansion.keep_spent = true;
+  worker->expansion.one_side = true;
+  worker->expansion.add_child = add_explore_child;
+  worker->expansion.data = worker;
+
+  for(;;)
+  {
+    u32 node_i;
+    if(pop_explore_deque(&worker->deque, &node_i) ||
+       steal_explore_work(worker, &node_i))
+    {
+      worker->expanding_node = node_i;
+      expand_search_state(ctx, &worker->expansion, &explorer->nodes[node_i].code);
+      worker->expanded_count++;
+
+      __atomic_fetch_sub(&explorer->pending_count, 1, __ATOMIC_RELEASE);
+    }
+    else if(!__atomic_load_n(&explorer->pending_count, __ATOMIC_ACQUIRE))
+    {
+      break;
+    }
+    else
+    {
+      sched_yield();
+    }
+  }
+
+  return 0;
+}
+
+// Mark winnable states backwards from the escape
+internal void
+mark_winnable_nodes(explorer_t *explorer, u32 node_count)
+{
+  u32 edge_count = 0;
+  for(i32 i = 0; i < explorer->worker_count; i++)
+  {
+    edge_count += explorer->workers[i].edge_count;
+  }
+
+  u32 *first_source = calloc(node_count + 1, sizeof(u32));
+  u32 *sources = malloc((edge_count + 1) * sizeof(u32));
+
+  for(i32 i = 0; i < explorer->worker_count; i++)
+  {
+    explore_worker_t *worker = &explorer->workers[i];
+    for(u32 edge_i = 0; edge_i < worker->edge_count; edge_i++)
+    {
+      first_source[worker->edges[edge_i].to + 1]++;
+    }
+  }
+
+  for(u32 node_i = 0; node_i < node_count; node_i++)
+  {
+    first_source[node_i + 1] += first_source[node_i];
+  }
+
+  u32 *source_count = calloc(node_count, sizeof(u32));
+  for(i32 i = 0; i < explorer->worker_count; i++)
+  {
+    explore_worker_t *worker = &explorer->workers[i];
+    for(u32 edge_i = 0; edge_i < worker->edge_count; edge_i++)
+    {
+      explore_edge_t *edge = &worker->edges[edge_i];
+      sources[first_source[edge->to] + source_count[edge->to]++] = edge->from;
+    }
+  }
+
+  u32 *queue = malloc(node_count * sizeof(u32));
+  u32 head = 0;
+  u32 tail = 0;
+
+  for(u32 node_i = 0; node_i < node_count; node_i++)
+  {
+    explore_node_t *node = &explorer->nodes[node_i];
+    if(node->escapes && !node->duplicate)
+    {
+      node->winnable = true;
+      queue[tail++] = node_i;
+    }
+  }
+
+  while(head < tail)
+  {
+    u32 node_i = queue[head++];
+    for(u32 i = first_source[node_i]; i < first_source[node_i + 1]; i++)
+    {
+      explore_node_t *source = &explorer->nodes[sources[i]];
+      if(!source->winnable)
+      {
+        source->winnable = true;
+        queue[tail++] = sources[i];
+      }
+    }
+  }
+
+  free(queue);
+  free(source_count);
+  free(sources);
+  free(first_source);
+}
+
+// Action kind without where it was done from
+internal u32
+get_edge_group(explore_edge_t *edge)
+{
+  return ((edge->action & 0x7FE7) << 8) | edge->glyph;
+}
+
+internal int
+compare_u64(const void *a, const void *b)
+{
+  u64 first = *(u64 *)a;
+  u64 second = *(u64 *)b;
+  return (first > second) - (first < second);
+}
+
+internal int
+compare_group_counts(const void *a, const void *b)
+{
+  // Count in the high half, group in the low half, largest count first
+  return compare_u64(b, a);
+}
+
+// Actions that throw the game away
+internal void
+print_dead_end_actions(explorer_t *explorer)
+{
+  u32 doomed_count = 0;
+  u32 doomed_capacity = 1024;
+  u64 *doomed = malloc(doomed_capacity * sizeof(u64));
+
+  for(i32 i = 0; i < explorer->worker_count; i++)
+  {
+    explore_worker_t *worker = &explorer->workers[i];
+    for(u32 edge_i = 0; edge_i < worker->edge_count; edge_i++)
+    {
+      explore_edge_t *edge = &worker->edges[edge_i];
+      if(explorer->nodes[edge->from].winnable && !explorer->nodes[edge->to].winnable)
+      {
+        if(doomed_count == doomed_capacity)
+        {
+          doomed_capacity *= 2;
+          doomed = realloc(doomed, doomed_capacity * sizeof(u64));
+        }
+
+        doomed[doomed_count++] = ((u64)get_edge_group(edge) << 32) | edge->from;
+      }
+    }
+  }
+
+  qsort(doomed, doomed_count, sizeof(u64), compare_u64);
+
+  u32 group_count = 0;
+  u64 *groups = malloc((doomed_count + 1) * sizeof(u64));
+  for(u32 i = 0; i < doomed_count; )
+  {
+    u32 group = (u32)(doomed[i] >> 32);
+    u32 count = 0;
+
+    u32 run = i;
+    while(run < doomed_count && (u32)(doomed[run] >> 32) == group)
+    {
+      if(run == i || doomed[run] != doomed[run - 1])
+      {
+        count++;
+      }
+
+      run++;
+    }
+
+    groups[group_count++] = ((u64)count << 32) | group;
+    i = run;
+  }
+
+  qsort(groups, group_count, sizeof(u64), compare_group_counts);
+
+  printf("Actions that turn a winnable state into a dead end, by states they do it in:\n");
+  for(u32 i = 0; i < group_count; i++)
+  {
+    u32 group = (u32)groups[i];
+    action_t action = group >> 8;
+    u8 glyph = (u8)group;
+
+    char first_name[GENERAL_LENGTH];
+    char second_name[GENERAL_LENGTH];
+    get_item_name_for_item_type(first_name, get_action_first_item(action));
+    get_item_name_for_item_type(second_name, get_action_second_item(action));
+
+    char description[MAX_LENGTH];
+    switch(get_action_kind(action))
+    {
+      case action_interact: sprintf(description, "interact with the %s", get_glyph_name(glyph)); break;
+      case action_pick_up: sprintf(description, "pick up from the %s", get_glyph_name(glyph)); break;
+      case action_use: sprintf(description, "use %s on the %s", first_name, get_glyph_name(glyph)); break;
+      case action_combine: sprintf(description, "combine %s with %s", first_name, second_name); break;
+      case action_escape: sprintf(description, "escape"); break;
+    }
+
+    printf("  %8u  %s\n", (u32)(groups[i] >> 32), description);
+  }
+
+  free(groups);
+  free(doomed);
+}
+
+internal r64
+get_seconds()
+{
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (r64)time.tv_sec + ((r64)time.tv_nsec / 1000000000.0);
+}
+
+i32
+main(i32 argc, char **argv)
+{
+  u32 max_states = EXPLORE_DEFAULT_MAX_STATES;
+  i32 thread_count = (i32)sysconf(_SC_NPROCESSORS_ONLN);
+
+  for(i32 i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--max-states") && (i + 1) < argc)
+    {
+      max_states = (u32)strtoul(argv[++i], 0, 10);
+    }
+    else if(!strcmp(argv[i], "--threads") && (i + 1) < argc)
+    {
+      thread_count = atoi(argv[++i]);
+    }
+    else
+    {
+      printf("Usage: %s [--max-states count] [--threads count]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  thread_count = thread_count < 1 ? 1 : thread_count;
+  thread_count = thread_count > EXPLORE_MAX_THREADS ? EXPLORE_MAX_THREADS : thread_count;
+
+  explorer_t *explorer = calloc(1, sizeof(explorer_t));
+  explorer->max_nodes = max_states;
+  explorer->nodes = malloc(max_states * sizeof(explore_node_t));
+  explorer->worker_count = thread_count;
+
+  u32 slot_count = 1;
+  while(slot_count < max_states * 2)
+  {
+    slot_count *= 2;
+  }
+
+  explorer->slots = calloc(slot_count, sizeof(u64));
+  explorer->slot_mask = slot_count - 1;
+
+  for(i32 i = 0; i < thread_count; i++)
+  {
+    explore_worker_t *worker = &explorer->workers[i];
+    worker->explorer = explorer;
+    worker->index = i;
+    worker->random = 0x9E3779B9 * (i + 1);
+    pthread_mutex_init(&worker->deque.lock, 0);
+  }
+
+  // The first worker's game is free to use until the workers start and
+  // again once they're done
+  rebirth_ctx_t *ctx = &explorer->workers[0].ctx;
+  init_game_data(ctx);
+  ctx->game.state = state_play;
+
+  state_code_t code;
+  encode_game_state(ctx, &code);
+  canonicalize_state_code(ctx, &code);
+
+  b32 added;
+  u32 start_node = add_explore_node(&explorer->workers[0], &code, &added);
+  explorer->pending_count = 1;
+  push_explore_deque(&explorer->workers[0].deque, start_node);
+
+  r64 start = get_seconds();
+  for(i32 i = 0; i < thread_count; i++)
+  {
+    pthread_create(&explorer->workers[i].thread, 0, run_explore_worker, &explorer->workers[i]);
+  }
+
+  for(i32 i = 0; i < thread_count; i++)
+  {
+    pthread_join(explorer->workers[i].thread, 0);
+  }
+  r64 seconds = get_seconds() - start;
+
+  u32 node_count = explorer->node_count < max_states ? explorer->node_count : max_states;
+  u32 state_count = 0;
+  u32 escape_count = 0;
+  u32 edge_count = 0;
+
+  for(u32 node_i = 0; node_i < node_count; node_i++)
+  {
+    if(!explorer->nodes[node_i].duplicate)
+    {
+      state_count++;
+      escape_count += explorer->nodes[node_i].escapes;
+    }
+  }
+
+  printf("Explored %u states in %.2fs on %d threads, %.0f states/s\n",
+         state_count, seconds, thread_count, state_count / seconds);
+
+  printf("States expanded per thread:");
+  for(i32 i = 0; i < thread_count; i++)
+  {
+    edge_count += explorer->workers[i].edge_count;
+    printf(" %u", explorer->workers[i].expanded_count);
+  }
+  printf("\n");
+
+  printf("%u actions between them, the escape is in walking distance from %u\n", edge_count, escape_count);
+
+  i32 result = EXIT_FAILURE;
+  if(explorer->out_of_states)
+  {
+    printf("State budget spent before every state was reached, dead ends can't be told apart.\n");
+  }
+  else
+  {
+    mark_winnable_nodes(explorer, node_count);
+
+    u32 winnable_count = 0;
+    for(u32 node_i = 0; node_i < node_count; node_i++)
+    {
+      explore_node_t *node = &explorer->nodes[node_i];
+      winnable_count += !node->duplicate && node->winnable;
+    }
+
+    printf("%u states can still be won, %u are dead ends\n", winnable_count, state_count - winnable_count);
+
+    // Has to agree with the soft lock check
+    u32 disagree_count = 0;
+    for(u32 node_i = 0; node_i < node_count; node_i++)
+    {
+      explore_node_t *node = &explorer->nodes[node_i];
+      if(!node->duplicate)
+      {
+        decode_game_state(ctx, &node->code);
+        disagree_count += (is_game_winnable(ctx) != node->winnable);
+      }
+    }
+
+    if(disagree_count)
+    {
+      printf("The soft-lock check gets %u states wrong\n", disagree_count);
+    }
+    else
+    {
+      printf("The soft-lock check agrees on every state\n");
+    }
+
+    print_dead_end_actions(explorer);
+
+    if(explorer->nodes[start_node].winnable && !disagree_count)
+    {
+      result = EXIT_SUCCESS;
+    }
+    else
+    {
+      printf("The room can't be escaped.\n");
+    }
+  }
+
+  for(i32 i = 0; i < thread_count; i++)
+  {
+    free(explorer->workers[i].deque.nodes);
+    free(explorer->workers[i].edges);
+  }
+
+  free(explorer->slots);
+  free(explorer->nodes);
+  free(explorer);
+
+  return result;
+}
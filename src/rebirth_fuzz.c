@@ -0,0 +1,745 @@
+#include "rebirth.c"
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <setjmp.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+
+#define FUZZ_MAX_KEYS 512
+#define FUZZ_MAX_THREADS 64
+#define FUZZ_CORPUS_COUNT 256
+#define FUZZ_COVERAGE_SLOTS (1 << 18)
+#define FUZZ_MAX_FAILURES 64
+
+typedef struct
+{
+  u32 count;
+  u8 keys[FUZZ_MAX_KEYS];
+} fuzz_input_t;
+
+typedef struct
+{
+  // What tells one failure apart from another, the rest of the message can
+  // change from input to input
+  char kind[MAX_LENGTH];
+  char message[MAX_LENGTH];
+  u64 count;
+  fuzz_input_t input;
+} fuzz_failure_t;
+
+typedef struct
+{
+  pthread_t thread;
+  rebirth_ctx_t ctx;
+  u64 random;
+  u64 turn_count;
+  u64 input_count;
+
+  // Inputs that got somewhere new, the ones mutated to make new inputs
+  u32 corpus_count;
+  fuzz_input_t corpus[FUZZ_CORPUS_COUNT];
+
+  // Hashes of what the games have been seen doing, zero means empty
+  u32 coverage_count;
+  u64 coverage[FUZZ_COVERAGE_SLOTS];
+} fuzz_worker_t;
+
+typedef struct
+{
+  char *directory;
+  b32 stop;
+
+  // The level every game is played in, the game's own one if it's not set
+  level_t *level;
+
+  pthread_mutex_t lock;
+  u32 failure_count;
+  fuzz_failure_t failures[FUZZ_MAX_FAILURES];
+
+  i32 worker_count;
+  fuzz_worker_t *workers;
+
+  fuzz_input_t seed;
+} fuzzer_t;
+
+global fuzzer_t fuzzer;
+global char fuzz_common_keys[] = "wasdwasdwasdbcpoiuuut.";
+
+// Last failure per thread
+static __thread jmp_buf fuzz_escape;
+static __thread char fuzz_kind[MAX_LENGTH];
+static __thread char fuzz_message[MAX_LENGTH];
+
+// The input running on this thread, written out if the rules crash
+static __thread fuzz_input_t *fuzz_running;
+
+// Where the game is unpacked to after every turn to see it comes back whole
+static __thread rebirth_ctx_t fuzz_unpacked;
+
+internal void
+report_bad_index(char *expression, i32 index, i32 line)
+{
+  snprintf(fuzz_kind, sizeof(fuzz_kind), "rebirth.c:%d: %s out of bounds", line, expression);
+  snprintf(fuzz_message, sizeof(fuzz_message), "%.200s (%d)", fuzz_kind, index);
+  longjmp(fuzz_escape, 1);
+}
+
+internal b32
+fail_invariant(char *kind)
+{
+  snprintf(fuzz_kind, sizeof(fuzz_kind), "%s", kind);
+  snprintf(fuzz_message, sizeof(fuzz_message), "%s", kind);
+  return false;
+}
+
+// Checked after every turn
+internal b32
+check_game_invariants(rebirth_ctx_t *ctx)
+{
+  i32 held_count = 0;
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    item_t *held = &ctx->player.inventory[i];
+    if(!held->in_inventory)
+    {
+      continue;
+    }
+
+    if(held_count != i)
+    {
+      return fail_invariant("the inventory has a gap in it");
+    }
+
+    held_count++;
+
+    i32 match_count = 0;
+    for(i32 item_i = 0; item_i < ITEM_COUNT; item_i++)
+    {
+      item_t *item = &ctx->items[item_i];
+      if(item->id == held->id && (item->active || item->in_inventory))
+      {
+        match_count++;
+
+        if(!item->in_inventory || item->active || item->type != held->type)
+        {
+          return fail_invariant("an inventory item disagrees with its item");
+        }
+      }
+    }
+
+    if(match_count != 1)
+    {
+      return fail_invariant("an inventory item doesn't have exactly one item");
+    }
+
+    if(held->use_count > held->max_use_count && held->max_use_count)
+    {
+      return fail_invariant("an item was used more than it can be");
+    }
+  }
+
+  if(held_count != ctx->player.inventory_item_count)
+  {
+    return fail_invariant("the inventory item count is off");
+  }
+
+  i32 in_inventory_count = 0;
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    item_t *item = &ctx->items[i];
+    if(item->active || item->in_inventory)
+    {
+      in_inventory_count += item->in_inventory;
+
+      if(item->active && item->in_inventory)
+      {
+        return fail_invariant("an item is both on the floor and held");
+      }
+
+      if(item->id <= 0)
+      {
+        return fail_invariant("an item has no id");
+      }
+
+      if(item->type <= item_none || item->type >= item_count)
+      {
+        return fail_invariant("an item has no type");
+      }
+
+      for(i32 other_i = i + 1; other_i < ITEM_COUNT; other_i++)
+      {
+        if((ctx->items[other_i].active || ctx->items[other_i].in_inventory) && ctx->items[other_i].id == item->id)
+        {
+          return fail_invariant("two items share an id");
+        }
+      }
+
+      if(item->active &&
+         (item->x < 0 || item->x >= ROOM_WIDTH || item->y < 0 || item->y >= ROOM_HEIGHT))
+      {
+        return fail_invariant("an item is outside the room");
+      }
+    }
+  }
+
+  if(in_inventory_count != held_count)
+  {
+    return fail_invariant("items held and the inventory disagree");
+  }
+
+  if(ctx->player.inventory_item_selected < 0 || ctx->player.inventory_item_selected > held_count)
+  {
+    return fail_invariant("the selected inventory item is out of range");
+  }
+
+  if(ctx->player.x < 0 || ctx->player.x >= ROOM_WIDTH || ctx->player.y < 0 || ctx->player.y >= ROOM_HEIGHT ||
+     !is_traversable(ctx, ctx->player.x, ctx->player.y))
+  {
+    return fail_invariant("the player is standing somewhere they can't");
+  }
+
+  room_t rebuilt = {0};
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+    for(i32 x = 0; x < ROOM_WIDTH; x++)
+    {
+      set_room_bits(&rebuilt, x, y, get_tile(ctx, x, y));
+    }
+  }
+
+  if(memcmp(rebuilt.traversable, ctx->room.traversable, sizeof(rebuilt.traversable)) ||
+     memcmp(rebuilt.opaque, ctx->room.opaque, sizeof(rebuilt.opaque)) ||
+     memcmp(rebuilt.burnable, ctx->room.burnable, sizeof(rebuilt.burnable)))
+  {
+    return fail_invariant("the room's bit rows disagree with its tiles");
+  }
+
+  u32 burning[ROOM_HEIGHT];
+  get_burning_rows(ctx, burning);
+
+  u32 any_burning = 0;
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+    if(burning[y] & ~ctx->room.burnable[y])
+    {
+      return fail_invariant("something that can't burn is burning");
+    }
+
+    any_burning |= burning[y];
+  }
+
+  if((any_burning != 0) != ctx->game.events[event_fire].pending)
+  {
+    return fail_invariant("the fire and its event disagree");
+  }
+
+  packed_game_t packed;
+  pack_game(ctx, &packed);
+  fuzz_unpacked.level = ctx->level;
+  unpack_game(&fuzz_unpacked, &packed);
+  memcpy(fuzz_unpacked.game.message, ctx->game.message, sizeof(ctx->game.message));
+
+  // The fire's back buffer has the turn before in it, nothing reads that
+  i32 back = !ctx->game.fire_front;
+  memcpy(fuzz_unpacked.game.fire[back], ctx->game.fire[back], sizeof(ctx->game.fire[back]));
+
+  // Emptied inventory slots keep some of what was in them, nothing reads that
+  player_t player = ctx->player;
+  for(i32 i = held_count; i < ITEM_COUNT; i++)
+  {
+    memset(&player.inventory[i], 0, sizeof(item_t));
+  }
+
+  if(memcmp(&fuzz_unpacked.game, &ctx->game, sizeof(game_t)) ||
+     memcmp(&fuzz_unpacked.player, &player, sizeof(player_t)) ||
+     memcmp(&fuzz_unpacked.room, &ctx->room, sizeof(room_t)) ||
+     memcmp(fuzz_unpacked.items, ctx->items, sizeof(ctx->items)) ||
+     fuzz_unpacked.searched != ctx->searched ||
+     memcmp(fuzz_unpacked.seen, ctx->seen, sizeof(ctx->seen)))
+  {
+    return fail_invariant("the game doesn't unpack to what was packed");
+  }
+
+  return true;
+}
+
+internal u64
+get_fuzz_random(u64 *random)
+{
+  *random ^= *random << 13;
+  *random ^= *random >> 7;
+  *random ^= *random << 17;
+  return *random;
+}
+
+// Keys a key file keeps
+internal u8
+get_random_fuzz_key(u64 *random)
+{
+  u32 roll = (u32)(get_fuzz_random(random) % 100);
+  if(roll < 60)
+  {
+    return (u8)fuzz_common_keys[get_fuzz_random(random) % (array_count(fuzz_common_keys) - 1)];
+  }
+  else if(roll < 95)
+  {
+    // Inventory slots, and the key just before 'a'
+    return (u8)(ASCII_LOWERCASE_START + (get_fuzz_random(random) % (ITEM_COUNT + 2)));
+  }
+  else if(roll < 96)
+  {
+    return 'q';
+  }
+
+  u8 key;
+  do
+  {
+    key = (u8)('!' + (get_fuzz_random(random) % ('~' - '!' + 1)));
+  } while(key == '#');
+
+  return key;
+}
+
+// Returns the key count it took to fail, or zero
+internal u32
+run_fuzz_input(rebirth_ctx_t *ctx, fuzz_worker_t *worker, fuzz_input_t *input)
+{
+  fuzz_running = input;
+  ctx->level = fuzzer.level;
+  init_game_data(ctx);
+  init_soft_lock(ctx);
+  ctx->game.state = state_play;
+
+  volatile u32 key_i = 0;
+  if(setjmp(fuzz_escape))
+  {
+    return key_i + 1;
+  }
+
+  for(; key_i < input->count; key_i++)
+  {
+    u8 key = input->keys[key_i];
+    step_game(ctx, key);
+
+    if(worker)
+    {
+      worker->turn_count++;
+    }
+
+    if(!check_game_invariants(ctx))
+    {
+      return key_i + 1;
+    }
+
+    if(ctx->game.state != state_play)
+    {
+      break;
+    }
+
+    if(worker && worker->coverage_count < (FUZZ_COVERAGE_SLOTS / 2))
+    {
+      u64 signature = ((u64)ctx->game.puzzle << 48) | ((u64)ctx->player.inventory_item_count << 40);
+      signature |= (u64)ctx->searched << 24;
+
+      for(i32 i = 0; i < ctx->player.inventory_item_count; i++)
+      {
+        signature |= (u64)1 << ctx->player.inventory[i].type;
+      }
+
+      signature = (signature * 0x9E3779B97F4A7C15) | 1;
+      u32 slot = (u32)(signature >> 48) & (FUZZ_COVERAGE_SLOTS - 1);
+      while(worker->coverage[slot] && worker->coverage[slot] != signature)
+      {
+        slot = (slot + 1) & (FUZZ_COVERAGE_SLOTS - 1);
+      }
+
+      if(!worker->coverage[slot])
+      {
+        worker->coverage[slot] = signature;
+        worker->coverage_count++;
+
+        // Got somewhere new, the keys up to here are worth building on
+        u32 corpus_i = worker->corpus_count < FUZZ_CORPUS_COUNT ?
+          worker->corpus_count++ : (u32)(get_fuzz_random(&worker->random) % FUZZ_CORPUS_COUNT);
+        fuzz_input_t *saved = &worker->corpus[corpus_i];
+        saved->count = key_i + 1;
+        memcpy(saved->keys, input->keys, saved->count);
+      }
+    }
+  }
+
+  return 0;
+}
+
+internal void
+make_fuzz_input(fuzz_worker_t *worker, fuzz_input_t *input)
+{
+  u64 *random = &worker->random;
+
+  if(!worker->corpus_count || !(get_fuzz_random(random) % 8))
+  {
+    input->count = 16 + (u32)(get_fuzz_random(random) % (FUZZ_MAX_KEYS - 16));
+    for(u32 i = 0; i < input->count; i++)
+    {
+      input->keys[i] = get_random_fuzz_key(random);
+    }
+
+    return;
+  }
+
+  *input = worker->corpus[get_fuzz_random(random) % worker->corpus_count];
+
+  u32 mutation_count = 1 + (u32)(get_fuzz_random(random) % 8);
+  for(u32 mutation_i = 0; mutation_i < mutation_count; mutation_i++)
+  {
+    u32 at = input->count ? (u32)(get_fuzz_random(random) % input->count) : 0;
+
+    switch(get_fuzz_random(random) % 5)
+    {
+      case 0:
+      {
+        if(input->count)
+        {
+          input->keys[at] = get_random_fuzz_key(random);
+        }
+      } break;
+
+      case 1:
+      {
+        if(input->count < FUZZ_MAX_KEYS)
+        {
+          memmove(input->keys + at + 1, input->keys + at, input->count - at);
+          input->keys[at] = get_random_fuzz_key(random);
+          input->count++;
+        }
+      } break;
+
+      case 2:
+      {
+        if(input->count)
+        {
+          memmove(input->keys + at, input->keys + at + 1, input->count - at - 1);
+          input->count--;
+        }
+      } break;
+
+      case 3:
+      {
+        // Take the tail of another input from here on
+        fuzz_input_t *other = &worker->corpus[get_fuzz_random(random) % worker->corpus_count];
+        u32 from = other->count ? (u32)(get_fuzz_random(random) % other->count) : 0;
+        u32 tail_count = other->count - from;
+        tail_count = (at + tail_count) > FUZZ_MAX_KEYS ? FUZZ_MAX_KEYS - at : tail_count;
+        memcpy(input->keys + at, other->keys + from, tail_count);
+        input->count = at + tail_count;
+      } break;
+
+      case 4:
+      {
+        while(input->count < FUZZ_MAX_KEYS && (get_fuzz_random(random) % 32))
+        {
+          input->keys[input->count++] = get_random_fuzz_key(random);
+        }
+      } break;
+    }
+  }
+}
+
+// Remove keys while it still fails the same way
+internal void
+minimize_fuzz_input(rebirth_ctx_t *ctx, fuzz_input_t *input, char *kind)
+{
+  char expected[MAX_LENGTH];
+  strcpy(expected, kind);
+
+  for(u32 chunk = input->count / 2; chunk; chunk /= 2)
+  {
+    for(u32 at = 0; at + chunk <= input->count; )
+    {
+      fuzz_input_t candidate;
+      candidate.count = input->count - chunk;
+      memcpy(candidate.keys, input->keys, at);
+      memcpy(candidate.keys + at, input->keys + at + chunk, input->count - at - chunk);
+
+      u32 failed_at = run_fuzz_input(ctx, 0, &candidate);
+      if(failed_at && !strcmp(fuzz_kind, expected))
+      {
+        candidate.count = failed_at;
+        *input = candidate;
+      }
+      else
+      {
+        at += chunk;
+      }
+    }
+  }
+
+  // Leave the failure of the smallest input behind for whoever asked
+  run_fuzz_input(ctx, 0, input);
+}
+
+internal b32
+write_fuzz_input(char *path, fuzz_input_t *input, char *message)
+{
+  FILE *file = fopen(path, "wb");
+  if(!file)
+  {
+    return false;
+  }
+
+  fprintf(file, "# rebirth-fuzz: %s\n", message);
+  for(u32 i = 0; i < input->count; i++)
+  {
+    fputc(input->keys[i], file);
+    if((i % 64) == 63 || i + 1 == input->count)
+    {
+      fputc('\n', file);
+    }
+  }
+
+  fclose(file);
+  return true;
+}
+
+internal void
+add_fuzz_failure(rebirth_ctx_t *ctx, fuzz_input_t *input)
+{
+  pthread_mutex_lock(&fuzzer.lock);
+
+  fuzz_failure_t *failure = 0;
+  for(u32 i = 0; i < fuzzer.failure_count; i++)
+  {
+    if(!strcmp(fuzzer.failures[i].kind, fuzz_kind))
+    {
+      failure = &fuzzer.failures[i];
+      break;
+    }
+  }
+
+  if(failure)
+  {
+    failure->count++;
+    pthread_mutex_unlock(&fuzzer.lock);
+  }
+  else if(fuzzer.failure_count < FUZZ_MAX_FAILURES)
+  {
+    failure = &fuzzer.failures[fuzzer.failure_count++];
+    strcpy(failure->kind, fuzz_kind);
+    failure->count = 1;
+    pthread_mutex_unlock(&fuzzer.lock);
+
+    // Shrinking it can take a while, the other threads carry on meanwhile
+    fuzz_input_t minimized = *input;
+    minimize_fuzz_input(ctx, &minimized, failure->kind);
+    strcpy(failure->message, fuzz_message);
+    failure->input = minimized;
+
+    char path[MAX_LENGTH];
+    snprintf(path, sizeof(path), "%s/fuzz-%u.keys", fuzzer.directory, (u32)(failure - fuzzer.failures));
+    write_fuzz_input(path, &minimized, fuzz_message);
+    printf("%s\n  %u keys, written to %s\n", fuzz_message, minimized.count, path);
+  }
+  else
+  {
+    pthread_mutex_unlock(&fuzzer.lock);
+  }
+}
+
+// Write the input out before a crash
+internal void
+handle_fuzz_crash(i32 signal_number)
+{
+  char path[MAX_LENGTH];
+  snprintf(path, sizeof(path), "%s/fuzz-crash.keys", fuzzer.directory);
+
+  i32 file = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if(file >= 0 && fuzz_running)
+  {
+    char header[] = "# rebirth-fuzz: crashed\n";
+    ssize_t written = write(file, header, sizeof(header) - 1);
+    written += write(file, fuzz_running->keys, fuzz_running->count);
+    (void)written;
+    close(file);
+  }
+
+  signal(signal_number, SIG_DFL);
+  raise(signal_number);
+}
+
+internal void *
+run_fuzz_worker(void *data)
+{
+  fuzz_worker_t *worker = (fuzz_worker_t *)data;
+  rebirth_ctx_t *ctx = &worker->ctx;
+
+  if(fuzzer.seed.count)
+  {
+    worker->corpus[worker->corpus_count++] = fuzzer.seed;
+  }
+
+  fuzz_input_t input;
+  while(!__atomic_load_n(&fuzzer.stop, __ATOMIC_RELAXED))
+  {
+    make_fuzz_input(worker, &input);
+    worker->input_count++;
+
+    u32 failed_at = run_fuzz_input(ctx, worker, &input);
+    if(failed_at)
+    {
+      input.count = failed_at;
+      add_fuzz_failure(ctx, &input);
+    }
+  }
+
+  return 0;
+}
+
+internal b32
+load_fuzz_input(fuzz_input_t *input, char *path)
+{
+  key_sequence_t sequence;
+  if(!load_key_sequence(&sequence, path))
+  {
+    return false;
+  }
+
+  input->count = sequence.count < FUZZ_MAX_KEYS ? sequence.count : FUZZ_MAX_KEYS;
+  memcpy(input->keys, sequence.keys, input->count);
+  free(sequence.keys);
+
+  return true;
+}
+
+i32
+main(i32 argc, char **argv)
+{
+  i32 thread_count = (i32)sysconf(_SC_NPROCESSORS_ONLN);
+  u32 seconds = 10;
+  char *check_path = 0;
+  char *seed_path = 0;
+  char *level_path = 0;
+  fuzzer.directory = ".";
+
+  for(i32 i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--threads") && (i + 1) < argc)
+    {
+      thread_count = atoi(argv[++i]);
+    }
+    else if(!strcmp(argv[i], "--seconds") && (i + 1) < argc)
+    {
+      seconds = (u32)strtoul(argv[++i], 0, 10);
+    }
+    else if(!strcmp(argv[i], "--out") && (i + 1) < argc)
+    {
+      fuzzer.directory = argv[++i];
+    }
+    else if(!strcmp(argv[i], "--seed") && (i + 1) < argc)
+    {
+      seed_path = argv[++i];
+    }
+    else if(!strcmp(argv[i], "--check") && (i + 1) < argc)
+    {
+      check_path = argv[++i];
+    }
+    else if(!strcmp(argv[i], "--level") && (i + 1) < argc)
+    {
+      level_path = argv[++i];
+    }
+    else
+    {
+      printf("Usage: %s [--threads count] [--seconds count] [--out directory] [--seed key file] [--level file]\n"
+             "       %s [--level file] --check key file\n", argv[0], argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  // A level the loader takes has to hold up to anything played in it
+  if(level_path)
+  {
+    fuzzer.level = malloc(sizeof(level_t));
+    if(!load_level(fuzzer.level, level_path))
+    {
+      printf("Could not read the level file %s.\n", level_path);
+      return EXIT_FAILURE;
+    }
+  }
+
+  if(check_path)
+  {
+    fuzz_input_t input;
+    if(!load_fuzz_input(&input, check_path))
+    {
+      printf("Could not read %s.\n", check_path);
+      return EXIT_FAILURE;
+    }
+
+    rebirth_ctx_t *ctx = calloc(1, sizeof(rebirth_ctx_t));
+    u32 failed_at = run_fuzz_input(ctx, 0, &input);
+    free(ctx);
+    free(fuzzer.level);
+
+    if(failed_at)
+    {
+      printf("%s\n  after %u keys\n", fuzz_message, failed_at);
+      return EXIT_FAILURE;
+    }
+
+    printf("%u keys played without a problem.\n", input.count);
+    return EXIT_SUCCESS;
+  }
+
+  if(seed_path && !load_fuzz_input(&fuzzer.seed, seed_path))
+  {
+    printf("Could not read %s.\n", seed_path);
+    return EXIT_FAILURE;
+  }
+
+  thread_count = thread_count < 1 ? 1 : thread_count;
+  thread_count = thread_count > FUZZ_MAX_THREADS ? FUZZ_MAX_THREADS : thread_count;
+
+  signal(SIGSEGV, handle_fuzz_crash);
+  signal(SIGBUS, handle_fuzz_crash);
+  signal(SIGFPE, handle_fuzz_crash);
+  signal(SIGABRT, handle_fuzz_crash);
+
+  pthread_mutex_init(&fuzzer.lock, 0);
+  fuzzer.worker_count = thread_count;
+  fuzzer.workers = calloc(thread_count, sizeof(fuzz_worker_t));
+
+  for(i32 i = 0; i < thread_count; i++)
+  {
+    fuzzer.workers[i].random = 0x9E3779B97F4A7C15 * (u64)(i + 1) ^ (u64)time(0);
+    pthread_create(&fuzzer.workers[i].thread, 0, run_fuzz_worker, &fuzzer.workers[i]);
+  }
+
+  sleep(seconds);
+  __atomic_store_n(&fuzzer.stop, true, __ATOMIC_RELAXED);
+
+  u64 turn_count = 0;
+  u64 input_count = 0;
+  u32 coverage_count = 0;
+  for(i32 i = 0; i < thread_count; i++)
+  {
+    pthread_join(fuzzer.workers[i].thread, 0);
+    turn_count += fuzzer.workers[i].turn_count;
+    input_count += fuzzer.workers[i].input_count;
+    coverage_count += fuzzer.workers[i].coverage_count;
+  }
+
+  printf("%llu turns from %llu inputs in %us on %d threads, %.0f turns/s\n",
+         (unsigned long long)turn_count, (unsigned long long)input_count, seconds, thread_count,
+         (r64)turn_count / (seconds ? seconds : 1));
+  printf("%u different situations reached\n", coverage_count);
+
+  for(u32 i = 0; i < fuzzer.failure_count; i++)
+  {
+    printf("%8llu  %s\n", (unsigned long long)fuzzer.failures[i].count, fuzzer.failures[i].kind);
+  }
+
+  free(fuzzer.workers);
+  free(fuzzer.level);
+  return fuzzer.failure_count ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,627 @@
+#include "rebirth.c"
+#include "rebirth_search.c"
+#include "rebirth_solver.c"
+
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#define GENERATE_MAX_THREADS 64
+#define GENERATE_DEFAULT_COUNT 100
+#define GENERATE_DEFAULT_MAX_STATES (1 << 16)
+#define GENERATE_MAX_TRIES 64
+
+// Estimate weight for checking rooms
+#define GENERATE_WEIGHT (SOLVE_WEIGHT_ONE * 2)
+
+typedef struct
+{
+  u32 index;
+  u32 escape_turns;
+  level_t level;
+} generated_level_t;
+
+typedef struct
+{
+  pthread_t thread;
+  rebirth_ctx_t ctx;
+  level_t level;
+  solver_t solver;
+} generate_worker_t;
+
+typedef struct
+{
+  u64 seed;
+  u32 count;
+  u32 max_states;
+  char *directory;
+
+  // Handed out in order, a room is made from the seed and its index alone
+  u32 next_index;
+  b32 stop;
+
+  pthread_mutex_t lock;
+  u32 rejected_count;
+  u32 unsolved_count;
+  u32 generated_count;
+  u32 generated_capacity;
+  generated_level_t *generated;
+
+  i32 worker_count;
+  generate_worker_t *workers;
+} generator_t;
+
+global generator_t generator;
+
+internal u64
+get_generate_random(u64 *random)
+{
+  u64 result = (*random += 0x9E3779B97F4A7C15);
+  result = (result ^ (result >> 30)) * 0xBF58476D1CE4E5B9;
+  result = (result ^ (result >> 27)) * 0x94D049BB133111EB;
+  return result ^ (result >> 31);
+}
+
+internal i32
+get_generate_range(u64 *random, i32 min, i32 max)
+{
+  i32 result = min + (i32)(get_generate_random(random) % (u64)(max - min + 1));
+  return result;
+}
+
+internal void
+carve_level(level_t *level, i32 left, i32 top, i32 right, i32 bottom)
+{
+  for(i32 y = top; y <= bottom; y++)
+  {
+    for(i32 x = left; x <= right; x++)
+    {
+      level->room[y][x] = glyph_floor;
+    }
+  }
+}
+
+internal i32
+get_level_neighbour_count(level_t *level, i32 x, i32 y, u8 glyph)
+{
+  i32 result = 0;
+
+  for(i32 direction = 0; direction < 4; direction++)
+  {
+    i32 next_x = x + direction_x[direction];
+    i32 next_y = y + direction_y[direction];
+
+    if(is_level_pos(next_x, next_y) && level->room[next_y][next_x] == glyph)
+    {
+      result++;
+    }
+  }
+
+  return result;
+}
+
+// Mark reachable floor, returns how much
+internal i32
+flood_level_floor(level_t *level, i32 start_x, i32 start_y, b32 *reached)
+{
+  memset(reached, 0, ROOM_WIDTH * ROOM_HEIGHT * sizeof(b32));
+
+  u8 queue[ROOM_WIDTH * ROOM_HEIGHT];
+  i32 head = 0;
+  i32 tail = 0;
+
+  reached[(start_y * ROOM_WIDTH) + start_x] = true;
+  queue[tail++] = (u8)((start_y * ROOM_WIDTH) + start_x);
+
+  while(head < tail)
+  {
+    i32 x = queue[head] % ROOM_WIDTH;
+    i32 y = queue[head] / ROOM_WIDTH;
+    head++;
+
+    for(i32 direction = 0; direction < 4; direction++)
+    {
+      i32 next_x = x + direction_x[direction];
+      i32 next_y = y + direction_y[direction];
+      i32 next = (next_y * ROOM_WIDTH) + next_x;
+
+      if(is_level_pos(next_x, next_y) &&
+         !reached[next] &&
+         level->room[next_y][next_x] == glyph_floor)
+      {
+        reached[next] = true;
+        queue[tail++] = (u8)next;
+      }
+    }
+  }
+
+  return tail;
+}
+
+// Not the floor between the doors
+internal i32
+get_level_floor_count(level_t *level)
+{
+  i32 result = 0;
+
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+    for(i32 x = 0; x < STONE_DOOR_X; x++)
+    {
+      result += (level->room[y][x] == glyph_floor);
+    }
+  }
+
+  return result;
+}
+
+internal b32
+is_level_floor_joined(level_t *level)
+{
+  b32 reached[ROOM_WIDTH * ROOM_HEIGHT];
+  b32 result = (flood_level_floor(level, STONE_DOOR_X - 1, level->exit_y, reached) == get_level_floor_count(level));
+  return result;
+}
+
+// Place next to the glyph, or anywhere if zero
+internal b32
+place_level_glyph(level_t *level, u64 *random, u8 glyph, u8 next_to, i32 *wood_count)
+{
+  if(is_burnable(glyph) && *wood_count >= LEVEL_MAX_WOOD)
+  {
+    return false;
+  }
+
+  for(i32 try_i = 0; try_i < GENERATE_MAX_TRIES; try_i++)
+  {
+    i32 x = get_generate_range(random, 1, STONE_DOOR_X - 1);
+    i32 y = get_generate_range(random, 1, ROOM_HEIGHT - 2);
+
+    if(level->room[y][x] == glyph_floor &&
+       !(y == level->exit_y && x >= STONE_DOOR_X - 2) &&
+       (!next_to || get_level_neighbour_count(level, x, y, next_to)))
+    {
+      level->room[y][x] = glyph;
+      if(is_level_floor_joined(level))
+      {
+        *wood_count += is_burnable(glyph);
+        return true;
+      }
+
+      level->room[y][x] = glyph_floor;
+    }
+  }
+
+  return false;
+}
+
+internal i32
+place_level_table(level_t *level, u64 *random, i32 *wood_count, i32 *table_tiles)
+{
+  for(i32 try_i = 0; try_i < GENERATE_MAX_TRIES; try_i++)
+  {
+    i32 width = get_generate_range(random, 2, 4);
+    i32 left = get_generate_range(random, 2, STONE_DOOR_X - 2 - width);
+    i32 top = get_generate_range(random, 2, ROOM_HEIGHT - 4);
+
+    // The whole table and a tile around it have to be floor, so every part of
+    // it can be reached
+    b32 fits = true;
+    for(i32 y = top - 1; y <= top + 2; y++)
+    {
+      for(i32 x = left - 1; x <= left + width; x++)
+      {
+        fits = fits && level->room[y][x] == glyph_floor && !(y == level->exit_y && x >= STONE_DOOR_X - 2);
+      }
+    }
+
+    if(fits)
+    {
+      i32 table_count = 0;
+      for(i32 y = top; y <= top + 1; y++)
+      {
+        for(i32 x = left; x < left + width; x++)
+        {
+          level->room[y][x] = glyph_table;
+          table_tiles[table_count++] = (y * ROOM_WIDTH) + x;
+        }
+      }
+
+      *wood_count += table_count;
+      return table_count;
+    }
+  }
+
+  return 0;
+}
+
+// Hall to the door wall and alcoves off it
+internal b32
+generate_level(level_t *level, u64 *random)
+{
+  memset(level, 0, sizeof(level_t));
+  memset(level->room, glyph_stone, sizeof(level->room));
+
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+    level->room[y][ROOM_WIDTH] = 0;
+  }
+
+  i32 left = get_generate_range(random, 3, 7);
+  i32 top = get_generate_range(random, 1, 3);
+  i32 bottom = get_generate_range(random, 6, ROOM_HEIGHT - 2);
+  carve_level(level, left, top, STONE_DOOR_X - 1, bottom);
+
+  i32 alcove_count = get_generate_range(random, 2, 6);
+  for(i32 i = 0; i < alcove_count; i++)
+  {
+    i32 width = get_generate_range(random, 1, 5);
+    i32 height = get_generate_range(random, 1, 2);
+    i32 x = get_generate_range(random, 1, STONE_DOOR_X - width);
+    i32 y = get_generate_range(random, 1, ROOM_HEIGHT - 1 - height);
+    carve_level(level, x, y, x + width - 1, y + height - 1);
+  }
+
+  level->exit_y = get_generate_range(random, top > 2 ? top : 2, bottom < ROOM_HEIGHT - 3 ? bottom : ROOM_HEIGHT - 3);
+
+  b32 reached[ROOM_WIDTH * ROOM_HEIGHT];
+  flood_level_floor(level, STONE_DOOR_X - 1, level->exit_y, reached);
+  for(i32 tile = 0; tile < ROOM_WIDTH * ROOM_HEIGHT; tile++)
+  {
+    if(!reached[tile])
+    {
+      level->room[tile / ROOM_WIDTH][tile % ROOM_WIDTH] = glyph_stone;
+    }
+  }
+
+  level->room[level->exit_y][STONE_DOOR_X] = glyph_stone_door;
+  level->room[level->exit_y][STONE_DOOR_X + 1] = glyph_floor;
+  level->room[level->exit_y][WOODEN_DOOR_X] = glyph_wooden_door;
+
+  // Furniture
+  i32 wood_count = 0;
+  i32 table_tiles[8];
+  i32 table_count = place_level_table(level, random, &wood_count, table_tiles);
+  if(table_count < LEVEL_ITEM_COUNT)
+  {
+    return false;
+  }
+
+  i32 chair_count = get_generate_range(random, 1, 4);
+  for(i32 i = 0; i < chair_count; i++)
+  {
+    place_level_glyph(level, random, glyph_chair, glyph_table, &wood_count);
+  }
+
+  i32 bookshelf_count = get_generate_range(random, 8, 14);
+  for(i32 i = 0; i < bookshelf_count; i++)
+  {
+    place_level_glyph(level, random, glyph_bookshelf, glyph_stone, &wood_count);
+  }
+
+  i32 crate_count = get_generate_range(random, 2, 5);
+  for(i32 i = 0; i < crate_count; i++)
+  {
+    place_level_glyph(level, random, glyph_crate, glyph_stone, &wood_count);
+  }
+
+  i32 small_crate_count = get_generate_range(random, 0, 3);
+  for(i32 i = 0; i < small_crate_count; i++)
+  {
+    place_level_glyph(level, random, glyph_small_crate, 0, &wood_count);
+  }
+
+  place_level_glyph(level, random, glyph_open_chest, glyph_stone, &wood_count);
+
+  i32 torch_count = get_generate_range(random, 1, 3);
+  for(i32 i = 0; i < torch_count; i++)
+  {
+    place_level_glyph(level, random, glyph_torch, glyph_stone, &wood_count);
+  }
+
+  // The chain hangs on a wall the player can stand next to
+  for(i32 try_i = 0; try_i < GENERATE_MAX_TRIES * 4; try_i++)
+  {
+    i32 x = get_generate_range(random, 0, STONE_DOOR_X - 2);
+    i32 y = get_generate_range(random, 0, ROOM_HEIGHT - 1);
+
+    if(level->room[y][x] == glyph_stone && get_level_neighbour_count(level, x, y, glyph_floor))
+    {
+      level->room[y][x] = glyph_chain;
+      break;
+    }
+  }
+
+  // Start
+  for(i32 try_i = 0; try_i < GENERATE_MAX_TRIES && !level->start_x; try_i++)
+  {
+    i32 x = get_generate_range(random, 1, STONE_DOOR_X - 1);
+    i32 y = get_generate_range(random, 1, ROOM_HEIGHT - 2);
+
+    if(level->room[y][x] == glyph_floor)
+    {
+      level->start_x = x;
+      level->start_y = y;
+    }
+  }
+
+  // Items go on the parts of the table that can still be reached
+  i32 reachable_table_count = 0;
+  for(i32 i = 0; i < table_count; i++)
+  {
+    if(get_level_neighbour_count(level, table_tiles[i] % ROOM_WIDTH, table_tiles[i] / ROOM_WIDTH, glyph_floor))
+    {
+      table_tiles[reachable_table_count++] = table_tiles[i];
+    }
+  }
+
+  if(!level->start_x || reachable_table_count < LEVEL_ITEM_COUNT)
+  {
+    return false;
+  }
+
+  for(i32 i = 0; i < LEVEL_ITEM_COUNT; i++)
+  {
+    i32 pick = get_generate_range(random, i, reachable_table_count - 1);
+    i32 tile = table_tiles[pick];
+    table_tiles[pick] = table_tiles[i];
+    table_tiles[i] = tile;
+
+    level->items[i] = rebirth_level.items[i];
+    level->items[i].x = tile % ROOM_WIDTH;
+    level->items[i].y = tile / ROOM_WIDTH;
+  }
+
+  // Searchables
+  i32 searchable_tiles[ROOM_WIDTH * ROOM_HEIGHT];
+  i32 searchable_tile_count = 0;
+  for(i32 tile = 0; tile < ROOM_WIDTH * ROOM_HEIGHT; tile++)
+  {
+    u8 glyph = level->room[tile / ROOM_WIDTH][tile % ROOM_WIDTH];
+    if((glyph == glyph_bookshelf || glyph == glyph_crate) &&
+       get_level_neighbour_count(level, tile % ROOM_WIDTH, tile / ROOM_WIDTH, glyph_floor))
+    {
+      searchable_tiles[searchable_tile_count++] = tile;
+    }
+  }
+
+  if(searchable_tile_count < SEARCHABLE_COUNT)
+  {
+    return false;
+  }
+
+  item_e loot[SEARCHABLE_COUNT * LOOT_COUNT];
+  i32 loot_count = 0;
+  for(i32 i = 0; i < SEARCHABLE_COUNT; i++)
+  {
+    for(i32 loot_i = 0; loot_i < LOOT_COUNT; loot_i++)
+    {
+      if(rebirth_level.searchables[i].loot[loot_i] != item_none)
+      {
+        loot[loot_count++] = rebirth_level.searchables[i].loot[loot_i];
+      }
+    }
+  }
+
+  for(i32 i = 0; i < loot_count; i++)
+  {
+    i32 pick = get_generate_range(random, i, loot_count - 1);
+    item_e type = loot[pick];
+    loot[pick] = loot[i];
+    loot[i] = type;
+  }
+
+  for(i32 i = 0; i < SEARCHABLE_COUNT; i++)
+  {
+    i32 pick = get_generate_range(random, i, searchable_tile_count - 1);
+    i32 tile = searchable_tiles[pick];
+    searchable_tiles[pick] = searchable_tiles[i];
+    searchable_tiles[i] = tile;
+
+    searchable_t *searchable = &level->searchables[i];
+    searchable->x = tile % ROOM_WIDTH;
+    searchable->y = tile / ROOM_WIDTH;
+    searchable->loot[0] = loot[i];
+    searchable->loot[1] = item_none;
+    searchable->loot[2] = item_none;
+  }
+
+  for(i32 i = SEARCHABLE_COUNT; i < loot_count; i++)
+  {
+    for(;;)
+    {
+      searchable_t *searchable = &level->searchables[get_generate_range(random, 0, SEARCHABLE_COUNT - 1)];
+      if(searchable->loot[LOOT_COUNT - 1] == item_none)
+      {
+        searchable->loot[searchable->loot[1] == item_none ? 1 : 2] = loot[i];
+        break;
+      }
+    }
+  }
+
+  return true;
+}
+
+internal void
+add_generated_level(generate_worker_t *worker, u32 index, u32 escape_turns)
+{
+  pthread_mutex_lock(&generator.lock);
+
+  generated_level_t *generated = &generator.generated[generator.generated_count++];
+  generated->index = index;
+  generated->escape_turns = escape_turns;
+  generated->level = worker->level;
+
+  if(generator.generated_count >= generator.count)
+  {
+    __atomic_store_n(&generator.stop, true, __ATOMIC_RELAXED);
+  }
+
+  pthread_mutex_unlock(&generator.lock);
+}
+
+// Same rooms whatever the thread count
+internal void *
+run_generate_worker(void *data)
+{
+  generate_worker_t *worker = (generate_worker_t *)data;
+  rebirth_ctx_t *ctx = &worker->ctx;
+  solver_t *solver = &worker->solver;
+
+  ctx->level = &worker->level;
+  init_solver(ctx, solver, generator.max_states);
+  solver->weight = GENERATE_WEIGHT;
+
+  while(!__atomic_load_n(&generator.stop, __ATOMIC_RELAXED))
+  {
+    u32 index = __atomic_fetch_add(&generator.next_index, 1, __ATOMIC_RELAXED);
+    u64 random = generator.seed ^ ((u64)index * 0xD1342543DE82EF95);
+
+    if(!generate_level(&worker->level, &random))
+    {
+      __atomic_fetch_add(&generator.rejected_count, 1, __ATOMIC_RELAXED);
+      continue;
+    }
+
+    set_solver_level(ctx, solver);
+    init_game_data(ctx);
+    ctx->game.state = state_play;
+
+    state_code_t start_code;
+    encode_game_state(ctx, &start_code);
+
+    u32 escape_turns = solve(ctx, solver, &start_code);
+    if(escape_turns == SOLVE_MAX_TURNS)
+    {
+      __atomic_fetch_add(&generator.unsolved_count, 1, __ATOMIC_RELAXED);
+    }
+    else
+    {
+      add_generated_level(worker, index, escape_turns);
+    }
+  }
+
+  free_solver(solver);
+  return 0;
+}
+
+internal int
+compare_generated_levels(const void *a, const void *b)
+{
+  u32 a_index = ((generated_level_t *)a)->index;
+  u32 b_index = ((generated_level_t *)b)->index;
+  return (a_index > b_index) - (a_index < b_index);
+}
+
+internal b32
+write_generated_level(generated_level_t *generated)
+{
+  char path[MAX_LENGTH];
+  snprintf(path, sizeof(path), "%s/level-%u.level", generator.directory, generated->index);
+
+  FILE *file = fopen(path, "wb");
+  if(!file)
+  {
+    printf("Could not write %s.\n", path);
+    return false;
+  }
+
+  fprintf(file, "# rebirth-generate: seed %llu, room %u, escaped in %u turns\n",
+          (unsigned long long)generator.seed, generated->index, generated->escape_turns);
+  write_level(file, &generated->level);
+  fclose(file);
+
+  return true;
+}
+
+internal r64
+get_seconds()
+{
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (r64)time.tv_sec + ((r64)time.tv_nsec / 1000000000.0);
+}
+
+i32
+main(i32 argc, char **argv)
+{
+  i32 thread_count = (i32)sysconf(_SC_NPROCESSORS_ONLN);
+  generator.seed = (u64)time(0);
+  generator.count = GENERATE_DEFAULT_COUNT;
+  generator.max_states = GENERATE_DEFAULT_MAX_STATES;
+  generator.directory = ".";
+
+  for(i32 i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--threads") && (i + 1) < argc)
+    {
+      thread_count = atoi(argv[++i]);
+    }
+    else if(!strcmp(argv[i], "--seed") && (i + 1) < argc)
+    {
+      generator.seed = strtoull(argv[++i], 0, 10);
+    }
+    else if(!strcmp(argv[i], "--count") && (i + 1) < argc)
+    {
+      generator.count = (u32)strtoul(argv[++i], 0, 10);
+    }
+    else if(!strcmp(argv[i], "--max-states") && (i + 1) < argc)
+    {
+      generator.max_states = (u32)strtoul(argv[++i], 0, 10);
+    }
+    else if(!strcmp(argv[i], "--out") && (i + 1) < argc)
+    {
+      generator.directory = argv[++i];
+    }
+    else
+    {
+      printf("Usage: %s [--threads count] [--seed number] [--count count] [--max-states count] [--out directory]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+
+  thread_count = thread_count < 1 ? 1 : thread_count;
+  thread_count = thread_count > GENERATE_MAX_THREADS ? GENERATE_MAX_THREADS : thread_count;
+  generator.count = generator.count < 1 ? 1 : generator.count;
+
+  // Every worker can still find one more room after the last one needed
+  pthread_mutex_init(&generator.lock, 0);
+  generator.generated_capacity = generator.count + thread_count;
+  generator.generated = malloc(generator.generated_capacity * sizeof(generated_level_t));
+  generator.worker_count = thread_count;
+  generator.workers = calloc(thread_count, sizeof(generate_worker_t));
+
+  r64 start = get_seconds();
+  for(i32 i = 0; i < thread_count; i++)
+  {
+    pthread_create(&generator.workers[i].thread, 0, run_generate_worker, &generator.workers[i]);
+  }
+
+  for(i32 i = 0; i < thread_count; i++)
+  {
+    pthread_join(generator.workers[i].thread, 0);
+  }
+  r64 seconds = get_seconds() - start;
+
+  qsort(generator.generated, generator.generated_count, sizeof(generated_level_t), compare_generated_levels);
+
+  u32 tried_count = generator.next_index;
+  printf("%u rooms tried in %.2fs on %d threads, %.0f rooms/min\n",
+         tried_count, seconds, thread_count, (r64)tried_count * 60.0 / (seconds > 0.0 ? seconds : 1.0));
+  printf("%u didn't lay out, %u couldn't be escaped within %u states, %u escaped\n",
+         generator.rejected_count, generator.unsolved_count, generator.max_states, generator.generated_count);
+
+  i32 result = EXIT_SUCCESS;
+  for(u32 i = 0; i < generator.count && i < generator.generated_count; i++)
+  {
+    if(!write_generated_level(&generator.generated[i]))
+    {
+      result = EXIT_FAILURE;
+      break;
+    }
+  }
+
+  free(generator.generated);
+  free(generator.workers);
+  return result;
+}
@@ -0,0 +1,283 @@
+#include "rebirth_search.c"
+#include "rebirth_solver.c"
+
+#include <pthread.h>
+#include <time.h>
+
+#define HINT_BUDGET_MS 50
+#define HINT_MAX_STATES (1 << 21)
+
+// Estimate weights, least trusted last
+global u32 hint_weights[] = {8, 6, 5, SOLVE_WEIGHT_ONE};
+
+typedef struct
+{
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  b32 running;
+
+  // The level the game is played in, the worker plays its copy in it too
+  level_t *level;
+
+  // Set by the game after every turn
+  state_code_t code;
+  u32 generation;
+  b32 stop;
+  b32 quit;
+
+  // Set by the worker, for the state of result_generation
+  u32 result_generation;
+  b32 out_of_budget;
+  b32 can_escape;
+  b32 exact;
+  u32 escape_turns;
+  i32 x;
+  i32 y;
+  char message[MAX_LENGTH];
+
+  // The tile the shown hint is about, drawn until the next turn
+  b32 shown;
+  i32 shown_x;
+  i32 shown_y;
+} hint_engine_t;
+
+global hint_engine_t hint;
+
+// Runs on the worker
+internal void
+describe_hint_action(rebirth_ctx_t *ctx, state_code_t *code, action_t action)
+{
+  decode_game_state(ctx, code);
+
+  i32 direction = get_action_direction(action);
+  i32 x = get_action_x(action) + direction_x[direction];
+  i32 y = get_action_y(action) + direction_y[direction];
+
+  char first_name[GENERAL_LENGTH];
+  char second_name[GENERAL_LENGTH];
+  get_item_name_for_item_type(first_name, get_action_first_item(action));
+  get_item_name_for_item_type(second_name, get_action_second_item(action));
+
+  switch(get_action_kind(action))
+  {
+    case action_interact:
+    {
+      if(is_searchable(ctx, x, y) == 1)
+      {
+        sprintf(hint.message, "Try searching the %s.", get_glyph_name(get_tile(ctx, x, y)));
+      }
+      else
+      {
+        sprintf(hint.message, "Try doing something with the %s.", get_glyph_name(get_tile(ctx, x, y)));
+      }
+    } break;
+
+    case action_pick_up:
+    {
+      get_item_name_for_item_type(first_name, get_item_type_for_pos(ctx, x, y));
+      sprintf(hint.message, "Try picking up the %s.", first_name);
+    } break;
+
+    case action_use: sprintf(hint.message, "Try using the %s on the %s.", first_name, get_glyph_name(get_tile(ctx, x, y))); break;
+    case action_combine: sprintf(hint.message, "Try combining the %s with the %s.", first_name, second_name); break;
+
+    case action_escape:
+    {
+      x = get_action_x(action);
+      y = get_action_y(action);
+      sprintf(hint.message, "The way out is open, all that's left is to walk through it.");
+    } break;
+  }
+
+  hint.x = (get_action_kind(action) == action_combine) ? -1 : x;
+  hint.y = y;
+}
+
+internal void *
+run_hint_worker(void *data)
+{
+  (void)data;
+
+  rebirth_ctx_t *ctx = calloc(1, sizeof(rebirth_ctx_t));
+  ctx->level = hint.level;
+  solver_t *solver = malloc(sizeof(solver_t));
+  init_solver(ctx, solver, HINT_MAX_STATES);
+  solver->stop = &hint.stop;
+
+  u32 worked_generation = 0;
+
+  pthread_mutex_lock(&hint.lock);
+  for(;;)
+  {
+    while(!hint.quit && hint.generation == worked_generation)
+    {
+      pthread_cond_wait(&hint.changed, &hint.lock);
+    }
+
+    if(hint.quit)
+    {
+      break;
+    }
+
+    u32 generation = hint.generation;
+    state_code_t code = hint.code;
+    __atomic_store_n(&hint.stop, false, __ATOMIC_RELAXED);
+    pthread_mutex_unlock(&hint.lock);
+
+    for(u32 i = 0; i < array_count(hint_weights); i++)
+    {
+      solver->weight = hint_weights[i];
+      u32 escape_turns = solve(ctx, solver, &code);
+      b32 out_of_budget = (escape_turns == SOLVE_MAX_TURNS && solver->node_count == solver->max_nodes);
+
+      // A later weight running out keeps the answer of the one before
+      if(__atomic_load_n(&hint.stop, __ATOMIC_RELAXED) || (out_of_budget && i))
+      {
+        break;
+      }
+
+      b32 can_escape = (escape_turns != SOLVE_MAX_TURNS);
+      action_t first_action;
+      if(can_escape)
+      {
+        get_solution_actions(solver, &first_action, 1);
+      }
+
+      pthread_mutex_lock(&hint.lock);
+      if(hint.generation == generation)
+      {
+        hint.result_generation = generation;
+        hint.out_of_budget = out_of_budget;
+        hint.can_escape = can_escape;
+        hint.exact = (solver->weight == SOLVE_WEIGHT_ONE) || !can_escape;
+        hint.escape_turns = escape_turns;
+
+        if(can_escape)
+        {
+          describe_hint_action(ctx, &code, first_action);
+        }
+
+        pthread_cond_broadcast(&hint.changed);
+      }
+      pthread_mutex_unlock(&hint.lock);
+
+      if(!can_escape)
+      {
+        break;
+      }
+    }
+
+    pthread_mutex_lock(&hint.lock);
+    worked_generation = generation;
+  }
+  pthread_mutex_unlock(&hint.lock);
+
+  free_solver(solver);
+  free(solver);
+  free(ctx);
+  return 0;
+}
+
+internal void
+init_hint_engine(level_t *level)
+{
+  hint.level = level;
+  pthread_mutex_init(&hint.lock, 0);
+  pthread_cond_init(&hint.changed, 0);
+  hint.running = !pthread_create(&hint.thread, 0, run_hint_worker, 0);
+}
+
+internal void
+quit_hint_engine()
+{
+  if(hint.running)
+  {
+    pthread_mutex_lock(&hint.lock);
+    hint.quit = true;
+    __atomic_store_n(&hint.stop, true, __ATOMIC_RELAXED);
+    pthread_cond_broadcast(&hint.changed);
+    pthread_mutex_unlock(&hint.lock);
+
+    pthread_join(hint.thread, 0);
+    hint.running = false;
+  }
+}
+
+// Hand the state to the worker
+internal void
+post_hint_state(rebirth_ctx_t *ctx)
+{
+  state_code_t code;
+  encode_game_state(ctx, &code);
+  hint.shown = false;
+
+  pthread_mutex_lock(&hint.lock);
+  if(!are_state_codes_equal(&code, &hint.code) || !hint.generation)
+  {
+    hint.code = code;
+    hint.generation++;
+    __atomic_store_n(&hint.stop, true, __ATOMIC_RELAXED);
+    pthread_cond_broadcast(&hint.changed);
+  }
+  pthread_mutex_unlock(&hint.lock);
+}
+
+// Wait at most HINT_BUDGET_MS
+internal void
+show_hint(rebirth_ctx_t *ctx)
+{
+  if(!hint.running)
+  {
+    push_message(ctx, "You can't think of anything right now.");
+    return;
+  }
+
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  deadline.tv_nsec += HINT_BUDGET_MS * 1000000;
+  if(deadline.tv_nsec >= 1000000000)
+  {
+    deadline.tv_sec++;
+    deadline.tv_nsec -= 1000000000;
+  }
+
+  pthread_mutex_lock(&hint.lock);
+  while(hint.result_generation != hint.generation)
+  {
+    if(pthread_cond_timedwait(&hint.changed, &hint.lock, &deadline))
+    {
+      break;
+    }
+  }
+
+  if(hint.result_generation != hint.generation)
+  {
+    push_message(ctx, "You're still thinking it over.. (H to ask again)");
+  }
+  else if(hint.out_of_budget)
+  {
+    push_message(ctx, "There's too much to think through, you can't work out a way from here.");
+  }
+  else if(!hint.can_escape)
+  {
+    push_message(ctx, "You can't think of any way out of here from where things are.");
+  }
+  else
+  {
+    if(hint.exact)
+    {
+      push_message(ctx, "%s\n  (%u turns to the way out)", hint.message, hint.escape_turns);
+    }
+    else
+    {
+      push_message(ctx, "%s\n  (%u turns to the way out, there might be a quicker way, H to keep thinking)",
+                   hint.message, hint.escape_turns);
+    }
+
+    hint.shown = (hint.x >= 0);
+    hint.shown_x = hint.x;
+    hint.shown_y = hint.y;
+  }
+  pthread_mutex_unlock(&hint.lock);
+}
@@ -0,0 +1,302 @@
+#include "rebirth.c"
+
+#include <fcntl.h>
+#include <sched.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+
+#define INSPECT_WATCH_MS 50
+#define INSPECT_MAX_LINES 64
+#define INSPECT_LINE_LENGTH 256
+
+global char *inspect_state_names[] =
+{
+  "main menu",
+  "intro",
+  "play",
+  "controls",
+  "quit",
+  "outro"
+};
+
+global char *inspect_puzzle_names[puzzle_flag_count] =
+{
+  "first_door_open",
+  "first_door_dihydrogen_monoxide_added",
+  "first_door_cupric_sulfate_added",
+  "first_door_spade_inserted",
+  "second_door_open",
+  "second_door_key_inserted",
+  "second_door_key_pried",
+  "second_door_key_complete",
+  "second_door_tin_ore_powder_added",
+  "second_door_cupric_ore_powder_added",
+  "second_door_key_imprint_made",
+  "second_door_gypsum_added",
+  "second_door_dihydrogen_monoxide_added"
+};
+
+typedef struct
+{
+  u32 count;
+  char lines[INSPECT_MAX_LINES][INSPECT_LINE_LENGTH];
+} inspect_lines_t;
+
+// Copy again if the sequence moved
+internal u32
+read_inspect_region(inspect_region_t *region, game_snapshot_t *snapshot)
+{
+  for(;;)
+  {
+    u32 sequence = __atomic_load_n(&region->sequence, __ATOMIC_ACQUIRE);
+    if(sequence & 1)
+    {
+      sched_yield();
+      continue;
+    }
+
+    memcpy(snapshot, &region->snapshot, sizeof(game_snapshot_t));
+    u32 frame = region->frame;
+
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if(__atomic_load_n(&region->sequence, __ATOMIC_RELAXED) == sequence)
+    {
+      return frame;
+    }
+  }
+}
+
+internal void
+add_inspect_line(inspect_lines_t *lines, char *format, ...)
+{
+  if(lines->count < INSPECT_MAX_LINES)
+  {
+    va_list arg_list;
+    va_start(arg_list, format);
+    vsnprintf(lines->lines[lines->count++], INSPECT_LINE_LENGTH, format, arg_list);
+    va_end(arg_list);
+  }
+}
+
+internal b32
+has_inspect_line(inspect_lines_t *lines, char *line)
+{
+  for(u32 i = 0; i < lines->count; i++)
+  {
+    if(!strcmp(lines->lines[i], line))
+    {
+      return true;
+    }
+  }
+
+  return false;
+}
+
+internal b32
+are_inspect_lines_equal(inspect_lines_t *a, inspect_lines_t *b)
+{
+  if(a->count != b->count)
+  {
+    return false;
+  }
+
+  for(u32 i = 0; i < a->count; i++)
+  {
+    if(strcmp(a->lines[i], b->lines[i]))
+    {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+// One named line per thing
+internal void
+describe_inspected_game(rebirth_ctx_t *ctx, inspect_lines_t *lines)
+{
+  lines->count = 0;
+
+  game_state_e state = ctx->game.state;
+  add_inspect_line(lines, "state: %s", (state <= state_outro) ? inspect_state_names[state] : "unknown");
+  add_inspect_line(lines, "turn: %d", ctx->player.turn);
+  add_inspect_line(lines, "position: %d, %d", ctx->player.x, ctx->player.y);
+  add_inspect_line(lines, "dark: %s", ctx->game.dark ? "yes" : "no");
+
+  // The message can run over a few lines
+  char message[MAX_LENGTH];
+  strcpy(message, ctx->game.message);
+  for(char *at = message; *at; at++)
+  {
+    *at = (*at == '\n') ? ' ' : *at;
+  }
+  add_inspect_line(lines, "message: %s", message);
+
+  for(i32 i = 0; i < puzzle_flag_count; i++)
+  {
+    add_inspect_line(lines, "puzzle %s: %d", inspect_puzzle_names[i], is_puzzle_flag_set(ctx, (puzzle_flag_e)i));
+  }
+
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    item_t *item = &ctx->player.inventory[i];
+    if(item->in_inventory)
+    {
+      add_inspect_line(lines, "inventory %c: %s (%d/%d uses)%s", 'a' + i, item->name, item->use_count,
+                       item->max_use_count, (i + 1 == ctx->player.inventory_item_selected) ? " selected" : "");
+    }
+  }
+
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    item_t *item = &ctx->items[i];
+    if(item->active && !item->in_inventory)
+    {
+      add_inspect_line(lines, "item %d: %s at %d, %d", item->id, item->name, item->x, item->y);
+    }
+  }
+
+  for(i32 i = 0; i < SEARCHABLE_COUNT; i++)
+  {
+    searchable_t *searchable = &ctx->level->searchables[i];
+    add_inspect_line(lines, "searchable %d: %s at %d, %d%s", i, get_glyph_name(ctx->level->room[searchable->y][searchable->x]),
+                     searchable->x, searchable->y, is_searched(ctx, i) ? " searched" : "");
+  }
+
+  state_code_t code;
+  encode_game_state(ctx, &code);
+  add_inspect_line(lines, "state code: %016llx", (unsigned long long)hash_state_code(&code));
+}
+
+i32
+main(i32 argc, char **argv)
+{
+  b32 watch = false;
+  i32 pid = 0;
+
+  for(i32 i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--watch"))
+    {
+      watch = true;
+    }
+    else if(!pid && atoi(argv[i]) > 0)
+    {
+      pid = atoi(argv[i]);
+    }
+    else
+    {
+      pid = 0;
+      break;
+    }
+  }
+
+  if(!pid)
+  {
+    printf("Usage: %s [--watch] pid\n", argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  char name[64];
+  snprintf(name, sizeof(name), INSPECT_NAME_FORMAT, pid);
+
+  i32 fd = shm_open(name, O_RDONLY, 0);
+  if(fd < 0)
+  {
+    printf("No game is running as %d.\n", pid);
+    return EXIT_FAILURE;
+  }
+
+  // Killed games leave their region behind
+  if(kill(pid, 0))
+  {
+    close(fd);
+    shm_unlink(name);
+    printf("The game that ran as %d is gone.\n", pid);
+    return EXIT_FAILURE;
+  }
+
+  inspect_region_t *region = mmap(0, sizeof(inspect_region_t), PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+
+  if(region == MAP_FAILED || __atomic_load_n(&region->version, __ATOMIC_ACQUIRE) != INSPECT_VERSION)
+  {
+    printf("The game running as %d can't be inspected by this build.\n", pid);
+    return EXIT_FAILURE;
+  }
+
+  // The level is written once before the version, the games after
+  rebirth_ctx_t *ctx = calloc(1, sizeof(rebirth_ctx_t));
+  level_t *level = malloc(sizeof(level_t));
+  *level = region->level;
+  ctx->level = level;
+
+  game_snapshot_t snapshot;
+  inspect_lines_t *lines = calloc(1, sizeof(inspect_lines_t));
+  inspect_lines_t *shown = calloc(1, sizeof(inspect_lines_t));
+
+  u32 frame = read_inspect_region(region, &snapshot);
+  load_game(ctx, &snapshot);
+  describe_inspected_game(ctx, shown);
+
+  printf("frame: %u\n", frame);
+  for(u32 i = 0; i < shown->count; i++)
+  {
+    printf("%s\n", shown->lines[i]);
+  }
+
+  // Print what changed until the game is gone
+  struct timespec wait = {0, INSPECT_WATCH_MS * 1000000};
+  while(watch && !kill(pid, 0))
+  {
+    nanosleep(&wait, 0);
+
+    u32 next_frame = read_inspect_region(region, &snapshot);
+    if(next_frame == frame)
+    {
+      continue;
+    }
+
+    frame = next_frame;
+    load_game(ctx, &snapshot);
+    describe_inspected_game(ctx, lines);
+
+    // A frame that only redrew the same game isn't worth a line
+    if(are_inspect_lines_equal(lines, shown))
+    {
+      continue;
+    }
+
+    printf("frame: %u\n", frame);
+    for(u32 i = 0; i < shown->count; i++)
+    {
+      if(!has_inspect_line(lines, shown->lines[i]))
+      {
+        printf("- %s\n", shown->lines[i]);
+      }
+    }
+
+    for(u32 i = 0; i < lines->count; i++)
+    {
+      if(!has_inspect_line(shown, lines->lines[i]))
+      {
+        printf("+ %s\n", lines->lines[i]);
+      }
+    }
+
+    fflush(stdout);
+
+    inspect_lines_t *swap = shown;
+    shown = lines;
+    lines = swap;
+  }
+
+  munmap(region, sizeof(inspect_region_t));
+  free(lines);
+  free(shown);
+  free(level);
+  free(ctx);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,224 @@
+#include <pthread.h>
+
+// Walking and the inventory
+global i32 predicted_keys[] = {'w', 'a', 's', 'd', 'b'};
+
+#define PREDICT_KEY_COUNT array_count(predicted_keys)
+
+typedef struct
+{
+  rebirth_ctx_t ctx;
+  game_output_t output;
+  screen_t screen;
+
+  // What the step logged, handed to the real log if the prediction is taken
+  play_log_t *log;
+} prediction_t;
+
+typedef struct
+{
+  pthread_t thread;
+  pthread_mutex_t lock;
+  pthread_cond_t changed;
+  b32 running;
+
+  // Set by the game before every wait for a key, the base is only there to
+  // be played out if it's of the current generation
+  rebirth_ctx_t base;
+  u32 base_generation;
+  u32 generation;
+  b32 quit;
+
+  // Set by the worker, one bit per key played out for the current generation
+  u32 ready;
+
+  // Only written by the worker while its bit isn't set
+  prediction_t predictions[array_count(predicted_keys)];
+} predictor_t;
+
+global predictor_t predictor;
+
+internal void *
+run_predict_worker(void *data)
+{
+  (void)data;
+
+  u32 worked_generation = 0;
+
+  pthread_mutex_lock(&predictor.lock);
+  for(;;)
+  {
+    while(!predictor.quit &&
+          (predictor.base_generation != predictor.generation || predictor.generation == worked_generation))
+    {
+      pthread_cond_wait(&predictor.changed, &predictor.lock);
+    }
+
+    if(predictor.quit)
+    {
+      break;
+    }
+
+    u32 generation = predictor.generation;
+
+    for(u32 i = 0; i < PREDICT_KEY_COUNT; i++)
+    {
+      // The base only changes under the lock, which isn't held while the
+      // key is played out
+      prediction_t *prediction = &predictor.predictions[i];
+      prediction->ctx = predictor.base;
+      pthread_mutex_unlock(&predictor.lock);
+
+      if(prediction->log)
+      {
+        prediction->log->head = 0;
+        prediction->log->dropped = 0;
+      }
+
+      prediction->ctx.play_log = prediction->log;
+      prediction->output = step_game(&prediction->ctx, predicted_keys[i]);
+      render_game(&prediction->screen, &prediction->ctx);
+
+      pthread_mutex_lock(&predictor.lock);
+      if(predictor.generation != generation || predictor.quit)
+      {
+        break;
+      }
+
+      predictor.ready |= (1 << i);
+    }
+
+    worked_generation = generation;
+  }
+  pthread_mutex_unlock(&predictor.lock);
+
+  return 0;
+}
+
+internal void
+init_predictor(b32 logging)
+{
+  if(logging)
+  {
+    for(u32 i = 0; i < PREDICT_KEY_COUNT; i++)
+    {
+      predictor.predictions[i].log = calloc(1, sizeof(play_log_t));
+    }
+  }
+
+  pthread_mutex_init(&predictor.lock, 0);
+  pthread_cond_init(&predictor.changed, 0);
+  predictor.running = !pthread_create(&predictor.thread, 0, run_predict_worker, 0);
+}
+
+internal void
+quit_predictor()
+{
+  if(predictor.running)
+  {
+    pthread_mutex_lock(&predictor.lock);
+    predictor.quit = true;
+    pthread_cond_broadcast(&predictor.changed);
+    pthread_mutex_unlock(&predictor.lock);
+
+    pthread_join(predictor.thread, 0);
+    predictor.running = false;
+  }
+
+  for(u32 i = 0; i < PREDICT_KEY_COUNT; i++)
+  {
+    free(predictor.predictions[i].log);
+    predictor.predictions[i].log = 0;
+  }
+}
+
+// Start predicting for the drawn frame
+internal void
+post_predict_state(rebirth_ctx_t *ctx)
+{
+  if(!predictor.running)
+  {
+    return;
+  }
+
+  pthread_mutex_lock(&predictor.lock);
+  predictor.ready = 0;
+  predictor.generation++;
+
+  if(ctx->game.state == state_play)
+  {
+    predictor.base = *ctx;
+    predictor.base_generation = predictor.generation;
+    pthread_cond_broadcast(&predictor.changed);
+  }
+  pthread_mutex_unlock(&predictor.lock);
+}
+
+// Move the predicted events to the real log
+internal void
+push_predicted_events(play_log_t *log, play_log_t *predicted)
+{
+  for(u32 i = 0; i < predicted->head; i++)
+  {
+    u32 head = log->head;
+    if(head - __atomic_load_n(&log->tail, __ATOMIC_ACQUIRE) == PLAY_LOG_SIZE)
+    {
+      log->dropped++;
+      continue;
+    }
+
+    log->events[head & (PLAY_LOG_SIZE - 1)] = predicted->events[i];
+    __atomic_store_n(&log->head, head + 1, __ATOMIC_RELEASE);
+  }
+
+  log->dropped += predicted->dropped;
+}
+
+// Take a ready prediction, never waits
+internal b32
+take_prediction(rebirth_ctx_t *ctx, screen_t *screen, i32 input, game_output_t *output)
+{
+  if(!predictor.running || ctx->game.state != state_play)
+  {
+    return false;
+  }
+
+  u32 key_i = 0;
+  while(key_i < PREDICT_KEY_COUNT && predicted_keys[key_i] != input)
+  {
+    key_i++;
+  }
+
+  if(key_i == PREDICT_KEY_COUNT)
+  {
+    return false;
+  }
+
+  b32 result = false;
+
+  pthread_mutex_lock(&predictor.lock);
+  if(predictor.ready & (1 << key_i))
+  {
+    prediction_t *prediction = &predictor.predictions[key_i];
+    play_log_t *log = ctx->play_log;
+
+    *ctx = prediction->ctx;
+    ctx->play_log = log;
+    *screen = prediction->screen;
+    *output = prediction->output;
+
+    if(log)
+    {
+      push_predicted_events(log, prediction->log);
+    }
+
+    result = true;
+  }
+
+  // Nothing the worker has is for the game anymore
+  predictor.ready = 0;
+  predictor.generation++;
+  pthread_mutex_unlock(&predictor.lock);
+
+  return result;
+}
@@ -0,0 +1,635 @@
+#define SCREEN_WIDTH 84
+#define SCREEN_HEIGHT 37
+
+// Line drawing glyphs
+enum
+{
+  glyph_line_horizontal = 0x80,
+  glyph_line_vertical,
+  glyph_corner_top_left,
+  glyph_corner_top_right,
+  glyph_corner_bottom_left,
+  glyph_corner_bottom_right
+} line_glyph_e;
+
+enum
+{
+  default_pair,
+  red_pair,
+  green_pair,
+  yellow_pair,
+  blue_pair,
+  magenta_pair,
+  cyan_pair,
+  white_pair,
+  
+  stone_pair,
+  wood_pair,
+  metal_pair,
+  light_pair,
+  dark_cyan_pair,
+  remembered_pair,
+  
+  color_pair_count
+} color_pair_e;
+
+// Or'd into a cell color to swap its foreground and background
+#define COLOR_REVERSE 0x80
+
+// Parts of a frame
+enum
+{
+  part_other,
+  part_room,
+  part_items,
+  part_player,
+  part_inventory,
+  part_message,
+  
+  part_count
+} render_part_e;
+
+typedef struct
+{
+  u8 glyph;
+  u8 color;
+} cell_t;
+
+// Drawn frame
+typedef struct
+{
+  cell_t cells[SCREEN_HEIGHT][SCREEN_WIDTH];
+  
+  // The part that drew each cell and the part being drawn
+  u8 parts[SCREEN_HEIGHT][SCREEN_WIDTH];
+  u8 part;
+} screen_t;
+
+// Bytes sent per part
+typedef struct
+{
+  u32 bytes[part_count];
+  u32 escapes[part_count];
+} frame_cost_t;
+
+typedef struct
+{
+  u32 count;
+  u32 capacity;
+  char *data;
+} terminal_output_t;
+
+internal void
+clear_screen(screen_t *screen)
+{
+  for(i32 y = 0; y < SCREEN_HEIGHT; y++)
+  {
+    for(i32 x = 0; x < SCREEN_WIDTH; x++)
+    {
+      screen->cells[y][x].glyph = ' ';
+      screen->cells[y][x].color = default_pair;
+      screen->parts[y][x] = part_other;
+    }
+  }
+  
+  screen->part = part_other;
+}
+
+internal void
+draw_glyph(screen_t *screen, i32 x, i32 y, u8 color, u8 glyph)
+{
+  if(x >= 0 && x < SCREEN_WIDTH && y >= 0 && y < SCREEN_HEIGHT)
+  {
+    screen->cells[y][x].glyph = glyph;
+    screen->cells[y][x].color = color;
+    screen->parts[y][x] = screen->part;
+  }
+}
+
+// Like mvprintw, wraps at newlines and the right edge
+internal void
+draw_text(screen_t *screen, i32 x, i32 y, u8 color, char *format, ...)
+{
+  char text[MAX_LENGTH * 2];
+  
+  va_list arg_list;
+  va_start(arg_list, format);
+  vsnprintf(text, sizeof(text), format, arg_list);
+  va_end(arg_list);
+  
+  for(char *at = text; *at; at++)
+  {
+    if(*at == '\n')
+    {
+      while(x < SCREEN_WIDTH)
+      {
+        draw_glyph(screen, x++, y, default_pair, ' ');
+      }
+    }
+    else
+    {
+      draw_glyph(screen, x++, y, color, (u8)*at);
+    }
+    
+    if(x >= SCREEN_WIDTH)
+    {
+      x = 0;
+      y++;
+    }
+  }
+}
+
+internal void
+draw_box(screen_t *screen, i32 left, i32 top, i32 right, i32 bottom)
+{
+  for(i32 x = left + 1; x < right; x++)
+  {
+    draw_glyph(screen, x, top, default_pair, glyph_line_horizontal);
+    draw_glyph(screen, x, bottom, default_pair, glyph_line_horizontal);
+  }
+  
+  for(i32 y = top + 1; y < bottom; y++)
+  {
+    draw_glyph(screen, left, y, default_pair, glyph_line_vertical);
+    draw_glyph(screen, right, y, default_pair, glyph_line_vertical);
+  }
+  
+  draw_glyph(screen, left, top, default_pair, glyph_corner_top_left);
+  draw_glyph(screen, right, top, default_pair, glyph_corner_top_right);
+  draw_glyph(screen, left, bottom, default_pair, glyph_corner_bottom_left);
+  draw_glyph(screen, right, bottom, default_pair, glyph_corner_bottom_right);
+}
+
+internal void
+render_main_menu(screen_t *screen, rebirth_ctx_t *ctx)
+{
+  draw_text(screen, 10, 5, default_pair, " _____  _____  _____  _____  _____  _____  _   _ ");
+  draw_text(screen, 10, 6, default_pair, "|  _  \\|  ___||  _  \\|_   _||  _  \\|_   _|| | | |");
+  draw_text(screen, 10, 7, default_pair, "| |_| /| |__  | |_| /  | |  | |_| /  | |  | |_| |");
+  draw_text(screen, 10, 8, default_pair, "| .  / |  __| |  _  \\  | |  | .  /   | |  |  _  |");
+  draw_text(screen, 10, 9, default_pair, "| |\\ \\ | |___ | |_| / _| |_ | |\\ \\   | |  | | | |");
+  draw_text(screen, 10, 10, default_pair, "\\_| \\_|\\____/ \\____/  \\___/ \\_| \\_|  \\_/  \\_| |_/");
+  
+  if(ctx->game.menu_option_selected == 1)
+  {
+    draw_text(screen, 10, 14, cyan_pair, "Play");
+    
+    draw_text(screen, 10, 15, default_pair, "Controls");
+    draw_text(screen, 10, 16, default_pair, "Quit");
+  }
+  else if(ctx->game.menu_option_selected == 2)
+  {
+    draw_text(screen, 10, 14, default_pair, "Play");
+    
+    draw_text(screen, 10, 15, cyan_pair, "Controls");
+    
+    draw_text(screen, 10, 16, default_pair, "Quit");
+  }
+  else
+  {
+    draw_text(screen, 10, 14, default_pair, "Play");
+    draw_text(screen, 10, 15, default_pair, "Controls");
+    
+    draw_text(screen, 10, 16, cyan_pair, "Quit");
+  }
+}
+
+internal void
+render_items(screen_t *screen, rebirth_ctx_t *ctx)
+{
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->items[i].active && is_visible(ctx, ctx->items[i].x, ctx->items[i].y))
+    {
+      char c[2] = {0};
+      c[0] = ctx->items[i].glyph;
+      draw_text(screen, ctx->items[i].x, ctx->items[i].y, default_pair, c);
+    }
+  }
+}
+
+internal void
+render_message(screen_t *screen, rebirth_ctx_t *ctx)
+{
+  if(ctx->game.dark)
+  {
+    draw_text(screen, 0, 15, default_pair, "> For a moment the torches seem to be snuffed out..\n  You get an uneasy feeling..");
+  }
+  else if(ctx->game.message[0])
+  {
+    draw_text(screen, 0, 15, default_pair, "> %s", ctx->game.message);
+  }
+  
+  if(ctx->soft_lock.lost)
+  {
+    draw_text(screen, 0, 21, red_pair, "> You get the feeling there's no way out of here anymore..\n  Press R to go back to when there still was.");
+  }
+}
+
+internal void
+render_room(screen_t *screen, rebirth_ctx_t *ctx)
+{
+  for(i32 x = 0; x < ROOM_WIDTH; x++)
+  {
+    for(i32 y = 0; y < ROOM_HEIGHT; y++)
+    {
+      char c[2] = {0};
+      c[0] = get_tile(ctx, x, y);
+      
+      u8 pair = white_pair;
+      
+      // Draw remembered tiles
+      if(!is_visible(ctx, x, y))
+      {
+        if(!is_seen(ctx, x, y))
+        {
+          c[0] = glyph_blank;
+        }
+        
+        pair = remembered_pair;
+      }
+      else if(is_burning(ctx, x, y))
+      {
+        pair = red_pair;
+      }
+      else if(get_tile(ctx, x, y) == glyph_stone ||
+              get_tile(ctx, x, y) == glyph_floor)
+      {
+        pair = stone_pair;
+      }
+      else if(get_tile(ctx, x, y) == glyph_bookshelf ||
+              get_tile(ctx, x, y) == glyph_crate ||
+              get_tile(ctx, x, y) == glyph_small_crate ||
+              get_tile(ctx, x, y) == glyph_table ||
+              get_tile(ctx, x, y) == glyph_chair ||
+              get_tile(ctx, x, y) == glyph_open_chest ||
+              get_tile(ctx, x, y) == glyph_wooden_door ||
+              get_tile(ctx, x, y) == glyph_wooden_door_open)
+      {
+        pair = wood_pair;
+      }
+      else if(get_tile(ctx, x, y) == glyph_stone_door ||
+              get_tile(ctx, x, y) == glyph_stone_door_open ||
+              get_tile(ctx, x, y) == glyph_chain)
+      {
+        pair = metal_pair;
+      }
+      else if(get_tile(ctx, x, y) == glyph_torch)
+      {
+        pair = yellow_pair;
+      }
+      
+      draw_text(screen, x, y, pair, c);
+    }
+  }
+}
+
+internal void
+render_player(screen_t *screen, rebirth_ctx_t *ctx)
+{
+  if(is_visible(ctx, ctx->player.x, ctx->player.y))
+  {
+    draw_text(screen, ctx->player.x, ctx->player.y, cyan_pair, "@");
+  }
+  else
+  {
+    draw_text(screen, ctx->player.x, ctx->player.y, default_pair, " ");
+  }
+}
+
+internal void
+render_inventory(screen_t *screen, rebirth_ctx_t *ctx)
+{
+  draw_text(screen, 49, 0, default_pair, "Inventory");
+  
+  draw_box(screen, 26, 1, 83, 12);
+  
+  i32 count = 0;
+  i32 start_x = 28;
+  i32 start_y = 2;
+  i32 x = start_x;
+  i32 y = start_y;
+  
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->player.inventory[i].in_inventory)
+    {
+      count++;
+      if(count == ctx->player.inventory_item_selected)
+      {
+        draw_text(screen, x, y, cyan_pair, "%c: %s", 96 + count, ctx->player.inventory[i].name);
+      }
+      else if(count == ctx->player.inventory_first_combination_item_num ||
+              count == ctx->player.inventory_second_combination_item_num)
+      {
+        draw_text(screen, x, y, dark_cyan_pair, "%c: %s", 96 + count, ctx->player.inventory[i].name);
+      }
+      else
+      {
+        draw_text(screen, x, y, default_pair, "%c: %s", 96 + count, ctx->player.inventory[i].name);
+      }
+      
+      y++;
+      if(y > 11)
+      {
+        x += 28;
+        y = 2;
+      }
+    }
+  }
+
+}
+
+internal void
+render_controls(screen_t *screen)
+{
+  draw_text(screen, 10, 5, default_pair, " _____   _____   _   _   _____   _____   _____   _      ______");
+  draw_text(screen, 10, 6, default_pair, "/  __ \\ /  _  \\ / \\ / \\ /_   _\\ /  _  \\ /  _  \\ / |    /  ____\\");
+  draw_text(screen, 10, 7, default_pair, "| /  \\/ | | | | |  \\| |   | |   | |_| / | | | | | |    | |____");
+  draw_text(screen, 10, 8, default_pair, "| |     | | | | | . ` |   | |   |    /  | | | | | |    \\____  \\");
+  draw_text(screen, 10, 9, default_pair, "| \\__/\\ | |_| | | |\\  |   | |   | |\\ \\  | |_| | | |___ _____| |");
+  draw_text(screen, 10, 10, default_pair, "\\_____/ \\_____/ \\_/ \\_/   \\_/   \\_/ \\_/ \\_____/ \\____/ \\______/");
+  
+  draw_text(screen, 10, 14, default_pair, "W: move up");
+  draw_text(screen, 10, 15, default_pair, "S: move down");
+  draw_text(screen, 10, 16, default_pair, "A: move left");
+  draw_text(screen, 10, 17, default_pair, "D: move right");
+  draw_text(screen, 10, 18, default_pair, ".: wait a turn");
+  
+  draw_text(screen, 10, 20, default_pair, "U: use item");
+  draw_text(screen, 10, 21, default_pair, "I: interact");
+  draw_text(screen, 10, 22, default_pair, "O: inspect");
+  draw_text(screen, 10, 23, default_pair, "P: pickup item");
+  draw_text(screen, 10, 24, default_pair, "T: walk over to an item, something to search or a door");
+  
+  draw_text(screen, 10, 26, default_pair, "B: toggle inventory");
+  draw_text(screen, 10, 27, default_pair, "C: in inventory choose two items to be combined");
+  
+  draw_text(screen, 10, 29, default_pair, "H: think about what to do next");
+  draw_text(screen, 10, 30, default_pair, "R: go back after getting stuck");
+  draw_text(screen, 10, 31, default_pair, "Q: quit back to main menu");
+  
+  draw_text(screen, 10, 33, default_pair, "[Enter] Return");
+}
+
+internal void
+render_intro(screen_t *screen, rebirth_ctx_t *ctx)
+{
+  draw_text(screen, 10, 2, default_pair, "Eyes are Open");
+  draw_text(screen, 10, 3, default_pair, "_____________");
+  
+  draw_text(screen, 28, 2, default_pair, "[Enter] Continue  [S] Skip");
+  
+  if(ctx->game.paragraph >= 1)
+  {
+    draw_text(screen, 10, 5, default_pair, "You awake and open your eyes wide staring infont of you, not sure if in a");
+    draw_text(screen, 10, 6, default_pair, "dream or not. As you look around the room which is barely illuminated by");
+    draw_text(screen, 10, 7, default_pair, "torches you try to get to your feet. It takes you a second since your bo-");
+    draw_text(screen, 10, 8, default_pair, "dy feels cold and worn. You refocus your eyes and take a deeper glance at.");
+    draw_text(screen, 10, 9, default_pair, "your surroundings. The room is filled with various things like a table,");
+    draw_text(screen, 10, 10, default_pair, "bookshelves, chairs and more.");
+  }
+
+  if(ctx->game.paragraph >= 2)
+  {
+    draw_text(screen, 10, 12, default_pair, "Your focus quickly changes to yourself, you seem to be wearing tattered");
+    draw_text(screen, 10, 13, default_pair, "clotches and it seems like you're not carrying anything of use. You try");
+    draw_text(screen, 10, 14, default_pair, "to reminisce who you are and why you are here but nothing comes to mind.");
+    draw_text(screen, 10, 15, default_pair, "It's almost like your brain doesn't allow you to remember.");
+  }
+}
+
+internal void
+render_outro(screen_t *screen, rebirth_ctx_t *ctx)
+{
+  draw_text(screen, 10, 2, default_pair, "Black and White");
+  draw_text(screen, 10, 3, default_pair, "_______________");
+  
+  draw_text(screen, 30, 2, default_pair, "[Enter] Continue  [S] Skip");
+  
+  if(ctx->game.paragraph >= 1)
+  {
+    draw_text(screen, 10, 5, default_pair, "You open the door and see.. nothing but a pitch blackness before you.");
+    draw_text(screen, 10, 6, default_pair, "You grab hold of one of the torches in the room and try to use it to\n");
+    draw_text(screen, 10, 7, default_pair, "light your way out. Finally, you can make out the start of a wide cor-");
+    draw_text(screen, 10, 8, default_pair, "ridor. You start walking in the center of it..");
+  }
+  
+  if(ctx->game.paragraph >= 2)
+  {
+    draw_text(screen, 10, 10, default_pair, "As you walk, the surrounding darkness and silence starts to feel more");
+    draw_text(screen, 10, 11, default_pair, "and more overwhelming. All you can hear is the sound of your footsteps");
+    draw_text(screen, 10, 12, default_pair, "which by now seem louder than the blaze of the torch. You squint your");
+    draw_text(screen, 10, 13, default_pair, "eyes.. and manage to make out a shape.");
+  }
+  
+  if(ctx->game.paragraph >= 3)
+  {
+    draw_text(screen, 10, 15, default_pair, "The shape gradually becomes more visible and a man is revealed.");
+    draw_text(screen, 10, 16, default_pair, "Caucasian and quite tall in stature, his face almost hidden by a hood");
+    draw_text(screen, 10, 17, default_pair, "and a mask both of which are white. You can see two bangs protruding");
+    draw_text(screen, 10, 18, default_pair, "from the hood one on either side in the shape of fangs. Donning a robe");
+    draw_text(screen, 10, 19, default_pair, "that's black but has white accents on it and short sleeves. His hands");
+    draw_text(screen, 10, 20, default_pair, "are mostly wrapped and a huge sword can be seen on his back which is");
+    draw_text(screen, 10, 21, default_pair, "held in place by a strap that spans across his chest in the shape of");
+    draw_text(screen, 10, 22, default_pair, "an x.");
+  }
+  
+  if(ctx->game.paragraph >= 4)
+  {
+    draw_text(screen, 10, 24, default_pair, "You quickly think about why this person is out here in the darkness ju-");
+    draw_text(screen, 10, 25, default_pair, "st standing around quietly, as if waiting for something. The person");
+    draw_text(screen, 10, 26, default_pair, "raises his head and opens his eyes which meet directly with yours. You");
+    draw_text(screen, 10, 27, default_pair, "decide to open your mouth to ask the person who he is and why you are");
+    draw_text(screen, 10, 28, default_pair, "here but to your surprise nothing comes out.");
+  }
+  
+  if(ctx->game.paragraph >= 5)
+  {
+    draw_text(screen, 10, 30, default_pair, "You attempt to move but you can't do that either, you feel paralyzed,");
+    draw_text(screen, 10, 31, default_pair, "by fear. The only thing you can sense is an immense feeling from the");
+    draw_text(screen, 10, 32, default_pair, "person in front of you. Just him standing there feels like he's burn-");
+    draw_text(screen, 10, 33, default_pair, "ing the air around him. Is he a monster? Before you can react, he's");
+    draw_text(screen, 10, 34, default_pair, "somehow in front of you. He slowly puts his hand in front of your face.");
+    draw_text(screen, 10, 35, default_pair, "His voice clearly reaches you and you hear him say \"Looks like you made");
+    draw_text(screen, 10, 36, default_pair, "it\". Suddenly your vision starts blurring and everything fades to black..");
+  }
+}
+
+// Draw the whole frame
+shared void
+render_game(screen_t *screen, rebirth_ctx_t *ctx)
+{
+  clear_screen(screen);
+  
+  switch(ctx->game.state)
+  {
+    case state_main_menu: render_main_menu(screen, ctx); break;
+    case state_intro: render_intro(screen, ctx); break;
+    case state_controls: render_controls(screen); break;
+    case state_outro: render_outro(screen, ctx); break;
+    
+    case state_play:
+    {
+      trace_begin("render_room");
+      screen->part = part_room;
+      render_room(screen, ctx);
+      trace_end();
+      
+      trace_begin("render_items");
+      screen->part = part_items;
+      render_items(screen, ctx);
+      trace_end();
+      
+      trace_begin("render_player");
+      screen->part = part_player;
+      render_player(screen, ctx);
+      trace_end();
+      
+      trace_begin("render_inventory");
+      screen->part = part_inventory;
+      render_inventory(screen, ctx);
+      trace_end();
+      
+      trace_begin("render_message");
+      screen->part = part_message;
+      render_message(screen, ctx);
+      trace_end();
+      
+      screen->part = part_other;
+    } break;
+    
+    default: break;
+  }
+}
+
+internal void
+push_terminal_output(terminal_output_t *output, char *data, u32 count)
+{
+  if(output->count + count > output->capacity)
+  {
+    output->capacity = output->capacity ? output->capacity * 2 : 4096;
+    while(output->count + count > output->capacity)
+    {
+      output->capacity *= 2;
+    }
+    
+    output->data = realloc(output->data, output->capacity);
+  }
+  
+  memcpy(output->data + output->count, data, count);
+  output->count += count;
+}
+
+internal void
+print_terminal_output(terminal_output_t *output, char *format, ...)
+{
+  char text[64];
+  
+  va_list arg_list;
+  va_start(arg_list, format);
+  i32 count = vsnprintf(text, sizeof(text), format, arg_list);
+  va_end(arg_list);
+  
+  push_terminal_output(output, text, (u32)count);
+}
+
+// 256 color palette
+global u8 terminal_colors[color_pair_count] =
+{
+  0, 196, 46, 226, 21, 201, 51, 231, 108, 130, 251, 229, 23, 241
+};
+
+// DEC special graphics
+global char terminal_line_glyphs[] = "qxlkmj";
+
+// Send the changed cells
+shared void
+write_screen_changes(terminal_output_t *output, screen_t *shown, screen_t *screen, frame_cost_t *cost)
+{
+  i32 cursor_x = -1;
+  i32 cursor_y = -1;
+  u32 color = 0xFFFFFFFF;
+  b32 drawing_lines = false;
+  
+  for(i32 y = 0; y < SCREEN_HEIGHT; y++)
+  {
+    for(i32 x = 0; x < SCREEN_WIDTH; x++)
+    {
+      cell_t *cell = &screen->cells[y][x];
+      cell_t *old = &shown->cells[y][x];
+      if(cell->glyph == old->glyph && cell->color == old->color)
+      {
+        continue;
+      }
+      
+      u32 count = output->count;
+      u32 escape_count = 0;
+      
+      if(x != cursor_x || y != cursor_y)
+      {
+        print_terminal_output(output, "\033[%d;%dH", y + 1, x + 1);
+        escape_count++;
+      }
+      
+      if(cell->color != color)
+      {
+        u8 pair = cell->color & ~COLOR_REVERSE;
+        if(pair == default_pair)
+        {
+          print_terminal_output(output, (cell->color & COLOR_REVERSE) ? "\033[0;7m" : "\033[0m");
+        }
+        else
+        {
+          print_terminal_output(output, (cell->color & COLOR_REVERSE) ? "\033[0;7;38;5;%um" : "\033[0;38;5;%um",
+                                terminal_colors[pair]);
+        }
+        
+        color = cell->color;
+        escape_count++;
+      }
+      
+      b32 is_line = (cell->glyph >= glyph_line_horizontal && cell->glyph <= glyph_corner_bottom_right);
+      if(is_line != drawing_lines)
+      {
+        push_terminal_output(output, is_line ? "\033(0" : "\033(B", 3);
+        drawing_lines = is_line;
+        escape_count++;
+      }
+      
+      char glyph = is_line ? terminal_line_glyphs[cell->glyph - glyph_line_horizontal] : (char)cell->glyph;
+      push_terminal_output(output, &glyph, 1);
+      
+      *old = *cell;
+      cursor_x = x + 1;
+      cursor_y = y;
+      
+      if(cost)
+      {
+        cost->bytes[screen->parts[y][x]] += output->count - count;
+        cost->escapes[screen->parts[y][x]] += escape_count;
+      }
+    }
+  }
+  
+  u32 count = output->count;
+  u32 escape_count = 0;
+  
+  if(drawing_lines)
+  {
+    push_terminal_output(output, "\033(B", 3);
+    escape_count++;
+  }
+  
+  if(color != 0xFFFFFFFF && color != default_pair)
+  {
+    push_terminal_output(output, "\033[0m", 4);
+    escape_count++;
+  }
+  
+  if(cost)
+  {
+    cost->bytes[part_other] += output->count - count;
+    cost->escapes[part_other] += escape_count;
+  }
+}
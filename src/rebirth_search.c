@@ -0,0 +1,444 @@
+// Shared by the tools that search the room
+
+#define SEARCH_UNREACHABLE 0xFFFF
+#define SEARCH_MAX_ACTION_KEYS 64
+
+typedef enum
+{
+  action_interact,
+  action_pick_up,
+  action_use,
+  action_combine,
+  action_escape
+} action_kind_e;
+
+// kind (3 bits) | direction (2 bits) | first item (5 bits) | second item (5 bits) | tile (8 bits)
+typedef u32 action_t;
+
+typedef struct
+{
+  u16 distance[ROOM_WIDTH][ROOM_HEIGHT];
+  u8 direction[ROOM_WIDTH][ROOM_HEIGHT];
+  u32 reached[ROOM_HEIGHT];
+} walk_field_t;
+
+// Called for every state one action away
+typedef void search_child_t(rebirth_ctx_t *ctx, void *data, state_code_t *code, action_t action, u32 turns);
+
+typedef struct
+{
+  game_snapshot_t parent;
+  state_code_t parent_code;
+  walk_field_t field;
+
+  // Keep actions that only spend item uses or leave ash behind
+  b32 keep_spent;
+
+  // Try each action from the first side it can be done from only
+  b32 one_side;
+
+  search_child_t *add_child;
+  void *data;
+} search_expansion_t;
+
+global char direction_keys[4] = {'w', 'a', 's', 'd'};
+global char *direction_names[4] = {"north", "west", "south", "east"};
+
+internal inline action_t
+make_action(action_kind_e kind, i32 direction, item_e first, item_e second, i32 x, i32 y)
+{
+  return (action_t)(kind | (direction << 3) | (first << 5) | (second << 10) | (((y * ROOM_WIDTH) + x) << 15));
+}
+
+internal inline action_kind_e get_action_kind(action_t action) { return (action_kind_e)(action & 0x7); }
+internal inline i32 get_action_direction(action_t action) { return (action >> 3) & 0x3; }
+internal inline item_e get_action_first_item(action_t action) { return (item_e)((action >> 5) & 0x1F); }
+internal inline item_e get_action_second_item(action_t action) { return (item_e)((action >> 10) & 0x1F); }
+internal inline i32 get_action_x(action_t action) { return ((action >> 15) & 0xFF) % ROOM_WIDTH; }
+internal inline i32 get_action_y(action_t action) { return ((action >> 15) & 0xFF) / ROOM_WIDTH; }
+
+shared void
+get_action_description(char *storage, action_t action)
+{
+  char first_name[GENERAL_LENGTH];
+  char second_name[GENERAL_LENGTH];
+  get_item_name_for_item_type(first_name, get_action_first_item(action));
+  get_item_name_for_item_type(second_name, get_action_second_item(action));
+
+  char *direction = direction_names[get_action_direction(action)];
+  switch(get_action_kind(action))
+  {
+    case action_interact: sprintf(storage, "interact %s", direction); break;
+    case action_pick_up: sprintf(storage, "pick up %s", direction); break;
+    case action_use: sprintf(storage, "use %s %s", first_name, direction); break;
+    case action_combine: sprintf(storage, "combine %s with %s", first_name, second_name); break;
+    case action_escape: sprintf(storage, "escape"); break;
+  }
+}
+
+internal void
+build_walk_field(rebirth_ctx_t *ctx, walk_field_t *field, i32 start_x, i32 start_y)
+{
+  memset(field->distance, 0xFF, sizeof(field->distance));
+  memset(field->reached, 0, sizeof(field->reached));
+
+  u32 frontier[ROOM_HEIGHT] = {0};
+  u32 stepped[4][ROOM_HEIGHT];
+  frontier[start_y] = (u32)1 << start_x;
+  field->reached[start_y] = frontier[start_y];
+  field->distance[start_x][start_y] = 0;
+
+  for(u16 distance = 1; step_room_flood(ctx, frontier, field->reached, stepped); distance++)
+  {
+    for(i32 direction = 0; direction < 4; direction++)
+    {
+      for(i32 y = 0; y < ROOM_HEIGHT; y++)
+      {
+        for(u32 bits = stepped[direction][y]; bits; bits &= bits - 1)
+        {
+          i32 x = __builtin_ctz(bits);
+          field->distance[x][y] = distance;
+          field->direction[x][y] = (u8)direction;
+        }
+      }
+    }
+  }
+}
+
+shared i32
+get_walk_keys(walk_field_t *field, i32 x, i32 y, u8 *keys)
+{
+  i32 key_count = field->distance[x][y];
+  for(i32 i = key_count - 1; i >= 0; i--)
+  {
+    i32 direction = field->direction[x][y];
+    keys[i] = direction_keys[direction];
+    x -= direction_x[direction];
+    y -= direction_y[direction];
+  }
+
+  return key_count;
+}
+
+// Press the action's keys, returns zero if it can't be done
+internal i32
+apply_action(rebirth_ctx_t *ctx, action_t action, u8 *keys)
+{
+  i32 key_count = 0;
+  u8 direction_key = direction_keys[get_action_direction(action)];
+
+  switch(get_action_kind(action))
+  {
+    case action_interact:
+    {
+      keys[key_count++] = 'i';
+      keys[key_count++] = direction_key;
+    } break;
+
+    case action_pick_up:
+    {
+      keys[key_count++] = 'p';
+      keys[key_count++] = direction_key;
+    } break;
+
+    case action_use:
+    {
+      i32 slot = get_inventory_position_for_item_type(ctx, get_action_first_item(action));
+      if(slot < 0)
+      {
+        return 0;
+      }
+
+      keys[key_count++] = 'u';
+      keys[key_count++] = direction_key;
+      keys[key_count++] = (u8)(ASCII_LOWERCASE_START + slot + 1);
+    } break;
+
+    case action_combine:
+    {
+      i32 first_slot = get_inventory_position_for_item_type(ctx, get_action_first_item(action));
+      i32 second_slot = get_inventory_position_for_item_type(ctx, get_action_second_item(action));
+      if(first_slot < 0 || second_slot < 0 || first_slot == second_slot)
+      {
+        return 0;
+      }
+
+      // Opening the inventory selects the first slot
+      keys[key_count++] = 'b';
+      for(i32 i = 0; i < first_slot; i++)
+      {
+        keys[key_count++] = 's';
+      }
+
+      keys[key_count++] = 'c';
+      for(i32 i = first_slot; i < second_slot; i++)
+      {
+        keys[key_count++] = 's';
+      }
+
+      for(i32 i = second_slot; i < first_slot; i++)
+      {
+        keys[key_count++] = 'w';
+      }
+
+      keys[key_count++] = 'c';
+    } break;
+
+    case action_escape:
+    {
+    } break;
+  }
+
+  for(i32 i = 0; i < key_count; i++)
+  {
+    update_game(ctx, keys[i]);
+  }
+
+  if(ctx->player.inventory_enabled)
+  {
+    keys[key_count++] = 'b';
+    update_game(ctx, 'b');
+  }
+
+  // The fire is waited out so the state is what it's coded as, the way to
+  // the next action can go through the ash
+  while(ctx->game.events[event_fire].pending)
+  {
+    check_index(key_count, SEARCH_MAX_ACTION_KEYS);
+    keys[key_count++] = '.';
+    update_game(ctx, '.');
+  }
+
+  return key_count;
+}
+
+// Try the action from every side of its target
+internal b32
+try_action_from_each_side(rebirth_ctx_t *ctx, search_expansion_t *expansion, action_kind_e kind, i32 target_x, i32 target_y, item_e item)
+{
+  game_snapshot_t *parent = &expansion->parent;
+  walk_field_t *field = &expansion->field;
+  u8 keys[SEARCH_MAX_ACTION_KEYS];
+
+  for(i32 direction = 0; direction < 4; direction++)
+  {
+    i32 x = target_x - direction_x[direction];
+    i32 y = target_y - direction_y[direction];
+
+    if(x < 0 || x >= ROOM_WIDTH ||
+       y < 0 || y >= ROOM_HEIGHT ||
+       field->distance[x][y] == SEARCH_UNREACHABLE)
+    {
+      continue;
+    }
+
+    load_game(ctx, parent);
+    ctx->player.x = x;
+    ctx->player.y = y;
+
+    action_t action = make_action(kind, direction, item, item_none, x, y);
+    if(!apply_action(ctx, action, keys))
+    {
+      return false;
+    }
+
+    // Most actions only leave a message behind, which is cheaper to see
+    // this way than by encoding
+    if(ctx->game.puzzle == parent->game.puzzle &&
+       !memcmp(ctx->player.inventory, parent->player.inventory, sizeof(ctx->player.inventory)) &&
+       !memcmp(ctx->items, parent->items, sizeof(ctx->items)) &&
+       ctx->searched == parent->searched &&
+       !memcmp(&ctx->room, &parent->room, sizeof(room_t)))
+    {
+      return false;
+    }
+
+    state_code_t code;
+    encode_game_state(ctx, &code);
+
+    if(!expansion->keep_spent)
+    {
+      state_code_t unchanged = expansion->parent_code;
+      unchanged.player_x = (u8)x;
+      unchanged.player_y = (u8)y;
+
+      state_code_t spent = code;
+      memcpy(spent.ash, unchanged.ash, sizeof(spent.ash));
+      memcpy(spent.use_counts, unchanged.use_counts, sizeof(spent.use_counts));
+
+      if(are_state_codes_equal(&spent, &unchanged))
+      {
+        return false;
+      }
+    }
+
+    // Every action takes one turn, waiting for a fire to go out takes more
+    u32 turns = (u32)(ctx->player.turn - parent->player.turn);
+    expansion->add_child(ctx, expansion->data, &code, action, field->distance[x][y] + turns);
+
+    if(expansion->one_side)
+    {
+      break;
+    }
+  }
+
+  return true;
+}
+
+// Expand every action
+internal void
+expand_search_state(rebirth_ctx_t *ctx, search_expansion_t *expansion, state_code_t *code)
+{
+  // The callback can move the code around, so work from a copy
+  expansion->parent_code = *code;
+  decode_game_state(ctx, &expansion->parent_code);
+  save_game(ctx, &expansion->parent);
+
+  game_snapshot_t *parent = &expansion->parent;
+  walk_field_t *field = &expansion->field;
+  build_walk_field(ctx, field, ctx->player.x, ctx->player.y);
+
+  item_e held[item_count];
+  i32 held_count = 0;
+  for(i32 type = item_none + 1; type < item_count; type++)
+  {
+    if(get_inventory_position_for_item_type(ctx, type) >= 0)
+    {
+      held[held_count++] = type;
+    }
+  }
+
+  // Trying an action changes the live game, so the targets are gathered
+  // from the parent state up front
+  u8 pick_up_targets[ROOM_WIDTH * ROOM_HEIGHT];
+  u8 furniture_targets[ROOM_WIDTH * ROOM_HEIGHT];
+  i32 pick_up_target_count = 0;
+  i32 furniture_target_count = 0;
+  i32 escape_x = -1;
+  i32 escape_y = -1;
+
+  // Tiles next to a reached one can be acted on
+  u32 item_rows[ROOM_HEIGHT];
+  u32 searchable_rows[ROOM_HEIGHT];
+  u32 reachable_rows[ROOM_HEIGHT];
+  get_item_rows(ctx, item_rows);
+  get_searchable_rows(ctx, searchable_rows);
+
+  for(i32 y = 0; y < ROOM_HEIGHT; y++)
+  {
+    u32 reached = field->reached[y];
+    reachable_rows[y] = ((reached << 1) | (reached >> 1)) & ROOM_ROW_MASK;
+    reachable_rows[y] |= (y > 0) ? field->reached[y - 1] : 0;
+    reachable_rows[y] |= (y + 1 < ROOM_HEIGHT) ? field->reached[y + 1] : 0;
+  }
+
+  for(i32 x = 0; x < ROOM_WIDTH; x++)
+  {
+    for(i32 y = 0; y < ROOM_HEIGHT; y++)
+    {
+      if((field->reached[y] >> x) & 1)
+      {
+        ctx->player.x = x;
+        ctx->player.y = y;
+
+        if(did_escape(ctx))
+        {
+          escape_x = x;
+          escape_y = y;
+        }
+      }
+
+      if((reachable_rows[y] >> x) & 1)
+      {
+        if((item_rows[y] >> x) & 1)
+        {
+          pick_up_targets[pick_up_target_count++] = (u8)((y * ROOM_WIDTH) + x);
+        }
+
+        if(get_tile(ctx, x, y) != glyph_floor && get_tile(ctx, x, y) != glyph_stone)
+        {
+          furniture_targets[furniture_target_count++] = (u8)((y * ROOM_WIDTH) + x);
+        }
+      }
+    }
+  }
+
+  if(escape_x >= 0)
+  {
+    load_game(ctx, parent);
+    ctx->player.x = escape_x;
+    ctx->player.y = escape_y;
+
+    state_code_t escape_code;
+    encode_game_state(ctx, &escape_code);
+    expansion->add_child(ctx, expansion->data, &escape_code,
+                         make_action(action_escape, 0, item_none, item_none, escape_x, escape_y),
+                         field->distance[escape_x][escape_y]);
+  }
+
+  for(i32 i = 0; i < pick_up_target_count; i++)
+  {
+    i32 x = pick_up_targets[i] % ROOM_WIDTH;
+    i32 y = pick_up_targets[i] / ROOM_WIDTH;
+    try_action_from_each_side(ctx, expansion, action_pick_up, x, y, item_none);
+  }
+
+  // Furniture with nothing in it or on it is only told apart by its glyph,
+  // so an action that does nothing to one piece does nothing to the rest of
+  // the same kind. One bit per item type, bit zero for interacting.
+  u32 glyph_idle_actions[256] = {0};
+
+  for(i32 i = 0; i < furniture_target_count; i++)
+  {
+    i32 x = furniture_targets[i] % ROOM_WIDTH;
+    i32 y = furniture_targets[i] / ROOM_WIDTH;
+    u32 *idle_actions = 0;
+
+    load_game(ctx, parent);
+    if(!(((searchable_rows[y] | item_rows[y]) >> x) & 1))
+    {
+      idle_actions = &glyph_idle_actions[get_tile(ctx, x, y)];
+    }
+
+    if(!idle_actions || !(*idle_actions & 1))
+    {
+      if(!try_action_from_each_side(ctx, expansion, action_interact, x, y, item_none) && idle_actions)
+      {
+        *idle_actions |= 1;
+      }
+    }
+
+    for(i32 held_i = 0; held_i < held_count; held_i++)
+    {
+      u32 bit = (u32)1 << held[held_i];
+      if(!idle_actions || !(*idle_actions & bit))
+      {
+        if(!try_action_from_each_side(ctx, expansion, action_use, x, y, held[held_i]) && idle_actions)
+        {
+          *idle_actions |= bit;
+        }
+      }
+    }
+  }
+
+  u8 keys[SEARCH_MAX_ACTION_KEYS];
+  for(i32 first = 0; first < held_count; first++)
+  {
+    for(i32 second = first + 1; second < held_count; second++)
+    {
+      load_game(ctx, parent);
+
+      action_t action = make_action(action_combine, 0, held[first], held[second], parent->player.x, parent->player.y);
+      if(apply_action(ctx, action, keys))
+      {
+        state_code_t code;
+        encode_game_state(ctx, &code);
+
+        if(!are_state_codes_equal(&code, &expansion->parent_code))
+        {
+          expansion->add_child(ctx, expansion->data, &code, action, 1);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,162 @@
+#include "rebirth.c"
+#include "rebirth_search.c"
+#include "rebirth_solver.c"
+
+#include <time.h>
+
+// Write the actions one per line
+internal b32
+write_solution(rebirth_ctx_t *ctx, solver_t *solver, char *path)
+{
+  u32 escape_turns = solver->escape_turns;
+  i32 action_count = get_solution_actions(solver, 0, 0);
+  action_t *path_actions = malloc(action_count * sizeof(action_t));
+  get_solution_actions(solver, path_actions, action_count);
+
+  FILE *file = fopen(path, "wb");
+  if(!file)
+  {
+    free(path_actions);
+    return false;
+  }
+
+  fprintf(file, "# rebirth-solve: %u turns\n", escape_turns);
+
+  init_game_data(ctx);
+  ctx->game.state = state_play;
+
+  for(i32 i = 0; i < action_count; i++)
+  {
+    action_t action = path_actions[i];
+
+    walk_field_t field;
+    build_walk_field(ctx, &field, ctx->player.x, ctx->player.y);
+
+    u8 keys[MAX_LENGTH];
+    i32 key_count = get_walk_keys(&field, get_action_x(action), get_action_y(action), keys);
+    for(i32 key_i = 0; key_i < key_count; key_i++)
+    {
+      update_game(ctx, keys[key_i]);
+    }
+
+    if(key_count)
+    {
+      fprintf(file, "%-24.*s # walk to %d, %d\n", key_count, keys, get_action_x(action), get_action_y(action));
+    }
+
+    if(get_action_kind(action) != action_escape)
+    {
+      char description[MAX_LENGTH];
+      get_action_description(description, action);
+
+      key_count = apply_action(ctx, action, keys);
+      fprintf(file, "%-24.*s # %s\n", key_count, keys, description);
+    }
+  }
+
+  fclose(file);
+  free(path_actions);
+
+  return ctx->game.state == state_outro && (u32)ctx->player.turn == escape_turns;
+}
+
+internal r64
+get_seconds()
+{
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (r64)time.tv_sec + ((r64)time.tv_nsec / 1000000000.0);
+}
+
+i32
+main(i32 argc, char **argv)
+{
+  char *path = "solution.keys";
+  u32 max_states = SOLVE_DEFAULT_MAX_STATES;
+  u32 weight = SOLVE_WEIGHT_ONE;
+  char *level_path = 0;
+
+  for(i32 i = 1; i < argc; i++)
+  {
+    if(!strcmp(argv[i], "--max-states") && (i + 1) < argc)
+    {
+      max_states = (u32)strtoul(argv[++i], 0, 10);
+    }
+    else if(!strcmp(argv[i], "--weight") && (i + 1) < argc)
+    {
+      weight = (u32)((atof(argv[++i]) * SOLVE_WEIGHT_ONE) + 0.5);
+      weight = weight < SOLVE_WEIGHT_ONE ? SOLVE_WEIGHT_ONE : weight;
+    }
+    else if(!strcmp(argv[i], "--level") && (i + 1) < argc)
+    {
+      level_path = argv[++i];
+    }
+    else if(argv[i][0] == '-')
+    {
+      printf("Usage: %s [--max-states count] [--weight factor] [--level level file] [key file]\n", argv[0]);
+      return EXIT_FAILURE;
+    }
+    else
+    {
+      path = argv[i];
+    }
+  }
+
+  rebirth_ctx_t *ctx = calloc(1, sizeof(rebirth_ctx_t));
+  level_t level;
+  if(level_path)
+  {
+    if(!load_level(&level, level_path))
+    {
+      printf("Could not read %s.\n", level_path);
+      free(ctx);
+      return EXIT_FAILURE;
+    }
+
+    ctx->level = &level;
+  }
+
+  solver_t *solver = malloc(sizeof(solver_t));
+  init_solver(ctx, solver, max_states);
+  solver->weight = weight;
+
+  init_game_data(ctx);
+  ctx->game.state = state_play;
+
+  state_code_t start_code;
+  encode_game_state(ctx, &start_code);
+
+  r64 start = get_seconds();
+  u32 escape_turns = solve(ctx, solver, &start_code);
+  r64 seconds = get_seconds() - start;
+
+  printf("%u states in %.2fs\n", solver->node_count, seconds);
+
+  i32 result = EXIT_FAILURE;
+  if(escape_turns == SOLVE_MAX_TURNS)
+  {
+    if(solver->node_count == solver->max_nodes)
+    {
+      printf("State budget spent before an escape was found.\n");
+    }
+    else
+    {
+      printf("The room can't be escaped.\n");
+    }
+  }
+  else if(!write_solution(ctx, solver, path))
+  {
+    printf("Could not write or verify %s.\n", path);
+  }
+  else
+  {
+    printf("Escaped in %u turns, written to %s.\n", escape_turns, path);
+    result = EXIT_SUCCESS;
+  }
+
+  free_solver(solver);
+  free(solver);
+  free(ctx);
+
+  return result;
+}
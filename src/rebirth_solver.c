@@ -0,0 +1,822 @@
+// Shortest escape search
+
+#define SOLVE_DEFAULT_MAX_STATES (1 << 23)
+#define SOLVE_MAX_TURNS 1024
+#define SOLVE_MAX_PLACES 20
+#define SOLVE_TOUR_UNKNOWN 0xFFFF
+
+// Estimate weights in quarters
+#define SOLVE_WEIGHT_ONE 4
+
+typedef struct
+{
+  state_code_t code;
+  u32 parent;
+  action_t action;
+  u16 turns;
+  u16 estimate;
+  b32 settled;
+} solve_node_t;
+
+typedef struct
+{
+  u32 count;
+  u32 capacity;
+  u32 *nodes;
+} solve_bucket_t;
+
+typedef struct
+{
+  u32 node_count;
+  u32 node_capacity;
+  u32 max_nodes;
+  solve_node_t *nodes;
+
+  // (hash >> 32) << 32 | (node index + 1), zero means empty
+  u64 *slots;
+  u32 slot_mask;
+
+  // Nodes waiting to be expanded, indexed by turns plus estimate
+  solve_bucket_t buckets[SOLVE_MAX_TURNS];
+  u32 expanding_bucket;
+
+  // Walking distance between any two tiles with every door open, filled once
+  b32 open_tiles[ROOM_WIDTH * ROOM_HEIGHT];
+  u8 open_distance[ROOM_WIDTH * ROOM_HEIGHT][ROOM_WIDTH * ROOM_HEIGHT];
+  i32 escape_tile;
+
+  // Tiles that can have to be visited before the escape, with a bitmask per
+  // place of the places that have to be visited before it
+  i32 place_count;
+  u8 place_tiles[SOLVE_MAX_PLACES];
+  u32 places_before[SOLVE_MAX_PLACES];
+  i8 place_for_tile[ROOM_WIDTH * ROOM_HEIGHT];
+  u16 place_walk_turns[SOLVE_MAX_PLACES][SOLVE_MAX_PLACES];
+  u16 place_escape_turns[SOLVE_MAX_PLACES];
+
+  // Shortest tour per set of places left and place the tour starts from
+  u16 *tour_turns;
+
+  // How much the estimate counts for against the turns already taken
+  u32 weight;
+
+  // Set from another thread to give up on the search, can be null
+  b32 *stop;
+
+  // The node being expanded and the best escape found so far
+  u32 expanding_node;
+  u32 escape_turns;
+  u32 escape_node;
+  action_t escape_action;
+} solver_t;
+
+// Item still to fetch
+typedef struct
+{
+  item_e type;
+  u16 flags;
+} solve_need_t;
+
+// Furniture still to visit
+typedef struct
+{
+  u8 glyph;
+  u16 flags;
+  item_e items[5];
+  u8 after[2];
+} solve_site_t;
+
+global solve_need_t solve_needs[] =
+{
+  {item_knife, 1 << puzzle_second_door_key_pried},
+  {item_tin, 1 << puzzle_second_door_key_pried},
+  {item_dihydrogen_monoxide, (1 << puzzle_first_door_dihydrogen_monoxide_added) | (1 << puzzle_second_door_dihydrogen_monoxide_added)},
+  {item_cupric_sulfate, 1 << puzzle_first_door_cupric_sulfate_added},
+  {item_gypsum, 1 << puzzle_second_door_gypsum_added},
+  {item_cupric_ore_powder, 1 << puzzle_second_door_cupric_ore_powder_added},
+  {item_tin_ore_powder, 1 << puzzle_second_door_tin_ore_powder_added},
+  {item_bunsen_burner, 1 << puzzle_second_door_key_complete}
+};
+
+global solve_site_t solve_sites[] =
+{
+  {glyph_chain, 1 << puzzle_second_door_key_imprint_made,
+   {item_tin, item_gypsum}, {0}},
+  {glyph_stone_door, (1 << puzzle_first_door_spade_inserted) | (1 << puzzle_first_door_cupric_sulfate_added) |
+                     (1 << puzzle_first_door_dihydrogen_monoxide_added) | (1 << puzzle_first_door_open),
+   {item_metal_spade, item_cupric_sulfate}, {0}},
+  {glyph_wooden_door, (1 << puzzle_second_door_key_inserted) | (1 << puzzle_second_door_open),
+   {item_tin, item_knife, item_gypsum, item_cupric_ore_powder, item_tin_ore_powder},
+   {glyph_chain, glyph_stone_door}}
+};
+
+// Distances with every door open
+internal void
+build_open_distances(rebirth_ctx_t *ctx, solver_t *solver)
+{
+  for(i32 tile = 0; tile < ROOM_WIDTH * ROOM_HEIGHT; tile++)
+  {
+    i32 x = tile % ROOM_WIDTH;
+    i32 y = tile / ROOM_WIDTH;
+    solver->open_tiles[tile] = is_traversable(ctx, x, y) ||
+                               get_tile(ctx, x, y) == glyph_stone_door ||
+                               get_tile(ctx, x, y) == glyph_wooden_door;
+  }
+
+  memset(solver->open_distance, 0xFF, sizeof(solver->open_distance));
+
+  for(i32 start = 0; start < ROOM_WIDTH * ROOM_HEIGHT; start++)
+  {
+    u8 *distance = solver->open_distance[start];
+    u8 queue[ROOM_WIDTH * ROOM_HEIGHT];
+    i32 head = 0;
+    i32 tail = 0;
+
+    distance[start] = 0;
+    queue[tail++] = (u8)start;
+
+    while(head < tail)
+    {
+      i32 x = queue[head] % ROOM_WIDTH;
+      i32 y = queue[head] / ROOM_WIDTH;
+      head++;
+
+      for(i32 direction = 0; direction < 4; direction++)
+      {
+        i32 next_x = x + direction_x[direction];
+        i32 next_y = y + direction_y[direction];
+        i32 next = (next_y * ROOM_WIDTH) + next_x;
+
+        if(next_x >= 0 && next_x < ROOM_WIDTH &&
+           next_y >= 0 && next_y < ROOM_HEIGHT &&
+           distance[next] == 0xFF &&
+           solver->open_tiles[next])
+        {
+          distance[next] = distance[(y * ROOM_WIDTH) + x] + 1;
+          queue[tail++] = (u8)next;
+        }
+      }
+    }
+  }
+
+  solver->escape_tile = -1;
+  for(i32 tile = 0; tile < ROOM_WIDTH * ROOM_HEIGHT; tile++)
+  {
+    ctx->player.x = tile % ROOM_WIDTH;
+    ctx->player.y = tile / ROOM_WIDTH;
+
+    if(did_escape(ctx))
+    {
+      solver->escape_tile = tile;
+      break;
+    }
+  }
+}
+
+// Where to stand for the tile
+internal i32
+get_stand_tiles(solver_t *solver, i32 tile, b32 next_to, i32 *stand_tiles)
+{
+  if(!next_to)
+  {
+    stand_tiles[0] = tile;
+    return 1;
+  }
+
+  i32 stand_tile_count = 0;
+  for(i32 direction = 0; direction < 4; direction++)
+  {
+    i32 x = (tile % ROOM_WIDTH) + direction_x[direction];
+    i32 y = (tile / ROOM_WIDTH) + direction_y[direction];
+
+    if(x >= 0 && x < ROOM_WIDTH &&
+       y >= 0 && y < ROOM_HEIGHT &&
+       solver->open_tiles[(y * ROOM_WIDTH) + x])
+    {
+      stand_tiles[stand_tile_count++] = (y * ROOM_WIDTH) + x;
+    }
+  }
+
+  return stand_tile_count;
+}
+
+// Walking turns with every door open
+internal u32
+get_open_walk_turns(solver_t *solver, i32 from, b32 from_next_to, i32 to, b32 to_next_to)
+{
+  i32 from_tiles[4];
+  i32 to_tiles[4];
+  i32 from_tile_count = get_stand_tiles(solver, from, from_next_to, from_tiles);
+  i32 to_tile_count = get_stand_tiles(solver, to, to_next_to, to_tiles);
+
+  u32 result = SEARCH_UNREACHABLE;
+  for(i32 from_i = 0; from_i < from_tile_count; from_i++)
+  {
+    for(i32 to_i = 0; to_i < to_tile_count; to_i++)
+    {
+      u32 distance = solver->open_distance[from_tiles[from_i]][to_tiles[to_i]];
+      if(distance != 0xFF && distance < result)
+      {
+        result = distance;
+      }
+    }
+  }
+
+  return result;
+}
+
+// Add the tile once
+internal void
+add_unique_tile(u8 *tiles, i32 *tile_count, i32 tile)
+{
+  for(i32 i = 0; i < *tile_count; i++)
+  {
+    if(tiles[i] == tile)
+    {
+      return;
+    }
+  }
+
+  tiles[(*tile_count)++] = (u8)tile;
+}
+
+// Where an item can still be fetched
+internal i32
+get_item_sources(rebirth_ctx_t *ctx, item_e type, u8 *sources)
+{
+  i32 source_count = 0;
+
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->items[i].active && ctx->items[i].type == type)
+    {
+      add_unique_tile(sources, &source_count, (ctx->items[i].y * ROOM_WIDTH) + ctx->items[i].x);
+    }
+  }
+
+  for(i32 i = 0; i < SEARCHABLE_COUNT; i++)
+  {
+    if(!is_searched(ctx, i))
+    {
+      for(i32 loot_i = 0; loot_i < LOOT_COUNT; loot_i++)
+      {
+        if(ctx->level->searchables[i].loot[loot_i] == type)
+        {
+          add_unique_tile(sources, &source_count, (ctx->level->searchables[i].y * ROOM_WIDTH) + ctx->level->searchables[i].x);
+        }
+      }
+    }
+  }
+
+  return source_count;
+}
+
+internal void
+add_solve_place(solver_t *solver, i32 tile)
+{
+  if(solver->place_for_tile[tile] < 0 && solver->place_count < SOLVE_MAX_PLACES)
+  {
+    solver->place_for_tile[tile] = (i8)solver->place_count;
+    solver->place_tiles[solver->place_count++] = (u8)tile;
+  }
+}
+
+// Places and the order they go in
+internal void
+build_solve_places(rebirth_ctx_t *ctx, solver_t *solver)
+{
+  memset(solver->place_for_tile, -1, sizeof(solver->place_for_tile));
+
+  for(i32 i = 0; i < ITEM_COUNT; i++)
+  {
+    if(ctx->items[i].active)
+    {
+      add_solve_place(solver, (ctx->items[i].y * ROOM_WIDTH) + ctx->items[i].x);
+    }
+  }
+
+  for(i32 i = 0; i < SEARCHABLE_COUNT; i++)
+  {
+    add_solve_place(solver, (ctx->level->searchables[i].y * ROOM_WIDTH) + ctx->level->searchables[i].x);
+  }
+
+  for(u32 site_i = 0; site_i < sizeof(solve_sites) / sizeof(solve_sites[0]); site_i++)
+  {
+    solve_site_t *site = &solve_sites[site_i];
+
+    for(i32 tile = 0; tile < ROOM_WIDTH * ROOM_HEIGHT; tile++)
+    {
+      if(get_tile(ctx, tile % ROOM_WIDTH, tile / ROOM_WIDTH) != site->glyph)
+      {
+        continue;
+      }
+
+      add_solve_place(solver, tile);
+      i32 place = solver->place_for_tile[tile];
+      if(place < 0)
+      {
+        continue;
+      }
+
+      for(i32 item_i = 0; item_i < 5 && site->items[item_i]; item_i++)
+      {
+        u8 sources[ROOM_WIDTH * ROOM_HEIGHT];
+        if(get_item_sources(ctx, site->items[item_i], sources) == 1 &&
+           solver->place_for_tile[sources[0]] >= 0)
+        {
+          solver->places_before[place] |= 1 << solver->place_for_tile[sources[0]];
+        }
+      }
+
+      for(i32 after_i = 0; after_i < 2 && site->after[after_i]; after_i++)
+      {
+        for(i32 after_tile = 0; after_tile < ROOM_WIDTH * ROOM_HEIGHT; after_tile++)
+        {
+          if(get_tile(ctx, after_tile % ROOM_WIDTH, after_tile / ROOM_WIDTH) == site->after[after_i] &&
+             solver->place_for_tile[after_tile] >= 0)
+          {
+            solver->places_before[place] |= 1 << solver->place_for_tile[after_tile];
+          }
+        }
+      }
+    }
+  }
+
+  // Sites that lead up to a site bring the places before them along
+  for(i32 pass = 0; pass < solver->place_count; pass++)
+  {
+    for(i32 place = 0; place < solver->place_count; place++)
+    {
+      for(i32 before = 0; before < solver->place_count; before++)
+      {
+        if(solver->places_before[place] & (1 << before))
+        {
+          solver->places_before[place] |= solver->places_before[before];
+        }
+      }
+    }
+  }
+
+  for(i32 from = 0; from < solver->place_count; from++)
+  {
+    for(i32 to = 0; to < solver->place_count; to++)
+    {
+      solver->place_walk_turns[from][to] = (u16)get_open_walk_turns(solver, solver->place_tiles[from], true,
+                                                                     solver->place_tiles[to], true);
+    }
+
+    solver->place_escape_turns[from] = (u16)get_open_walk_turns(solver, solver->place_tiles[from], true,
+                                                                 solver->escape_tile, false);
+  }
+
+  u32 tour_count = ((u32)1 << solver->place_count) * solver->place_count;
+  solver->tour_turns = malloc(tour_count * sizeof(u16));
+  memset(solver->tour_turns, 0xFF, tour_count * sizeof(u16));
+}
+
+// Shortest walk through the places and out
+internal u32
+get_tour_turns(solver_t *solver, u32 places, i32 from)
+{
+  u16 *tour_turns = &solver->tour_turns[(places * solver->place_count) + from];
+  if(*tour_turns == SOLVE_TOUR_UNKNOWN)
+  {
+    u32 result = SEARCH_UNREACHABLE;
+    if(!places)
+    {
+      result = solver->place_escape_turns[from];
+    }
+
+    for(i32 next = 0; next < solver->place_count; next++)
+    {
+      if((places & (1 << next)) && !(places & solver->places_before[next]))
+      {
+        u32 walk_turns = solver->place_walk_turns[from][next];
+        u32 rest_turns = get_tour_turns(solver, places & ~(1 << next), next);
+        if(walk_turns + rest_turns < result)
+        {
+          result = walk_turns + rest_turns;
+        }
+      }
+    }
+
+    // SEARCH_UNREACHABLE doubles as unknown here, one below it stands in
+    *tour_turns = (u16)(result < SEARCH_UNREACHABLE ? result : SEARCH_UNREACHABLE - 1);
+  }
+
+  return *tour_turns == SEARCH_UNREACHABLE - 1 ? SEARCH_UNREACHABLE : *tour_turns;
+}
+
+// Lower bound on the turns left, or SEARCH_UNREACHABLE
+internal u32
+get_turns_estimate(rebirth_ctx_t *ctx, solver_t *solver)
+{
+  u32 action_turns = 0;
+  for(i32 flag = 0; flag < puzzle_flag_count; flag++)
+  {
+    if(!is_puzzle_flag_set(ctx, flag))
+    {
+      action_turns++;
+    }
+  }
+
+  item_e needed[item_count];
+  i32 needed_count = 0;
+
+  // The handle has to be burned off the spade before it goes in the door
+  b32 spade_burn_needed = !is_puzzle_flag_set(ctx, puzzle_first_door_spade_inserted) &&
+                          get_inventory_position_for_item_type(ctx, item_metal_spade_no_handle) < 0;
+  if(spade_burn_needed)
+  {
+    action_turns++;
+
+    if(get_inventory_position_for_item_type(ctx, item_metal_spade) < 0)
+    {
+      needed[needed_count++] = item_metal_spade;
+    }
+  }
+
+  for(u32 i = 0; i < sizeof(solve_needs) / sizeof(solve_needs[0]); i++)
+  {
+    solve_need_t *need = &solve_needs[i];
+    if((ctx->game.puzzle & need->flags) != need->flags ||
+       (need->type == item_bunsen_burner && spade_burn_needed))
+    {
+      i32 slot = get_inventory_position_for_item_type(ctx, need->type);
+      if(slot < 0)
+      {
+        needed[needed_count++] = need->type;
+      }
+      else if(ctx->player.inventory[slot].max_use_count &&
+              ctx->player.inventory[slot].use_count >= ctx->player.inventory[slot].max_use_count)
+      {
+        return SEARCH_UNREACHABLE;
+      }
+    }
+  }
+
+  // Items with a single place left to get them from pin that place down,
+  // items with more than one only bound the walk by the nearest of them
+  u32 places = 0;
+  u32 spread_turns = 0;
+  i32 spread_count = 0;
+  u8 spread_sources[item_count][ROOM_WIDTH * ROOM_HEIGHT];
+  i32 spread_source_counts[item_count];
+  i32 player_tile = (ctx->player.y * ROOM_WIDTH) + ctx->player.x;
+
+  for(i32 i = 0; i < needed_count; i++)
+  {
+    u8 sources[ROOM_WIDTH * ROOM_HEIGHT];
+    i32 source_count = get_item_sources(ctx, needed[i], sources);
+
+    if(!source_count)
+    {
+      return SEARCH_UNREACHABLE;
+    }
+    else if(source_count == 1 && solver->place_for_tile[sources[0]] >= 0)
+    {
+      places |= 1 << solver->place_for_tile[sources[0]];
+    }
+    else
+    {
+      memcpy(spread_sources[spread_count], sources, source_count);
+      spread_source_counts[spread_count++] = source_count;
+    }
+  }
+
+  action_turns += __builtin_popcount(places);
+
+  for(i32 i = 0; i < spread_count; i++)
+  {
+    u32 fetch_turns = SEARCH_UNREACHABLE;
+    b32 fetched_on_the_way = false;
+
+    for(i32 source_i = 0; source_i < spread_source_counts[i]; source_i++)
+    {
+      i32 source = spread_sources[i][source_i];
+      u32 turns = get_open_walk_turns(solver, player_tile, false, source, true) +
+                  get_open_walk_turns(solver, source, true, solver->escape_tile, false);
+      fetch_turns = turns < fetch_turns ? turns : fetch_turns;
+
+      i32 place = solver->place_for_tile[source];
+      if(place >= 0 && (places & (1 << place)))
+      {
+        fetched_on_the_way = true;
+      }
+    }
+
+    if(!fetched_on_the_way)
+    {
+      action_turns++;
+    }
+
+    spread_turns = fetch_turns > spread_turns ? fetch_turns : spread_turns;
+  }
+
+  for(u32 i = 0; i < sizeof(solve_sites) / sizeof(solve_sites[0]); i++)
+  {
+    solve_site_t *site = &solve_sites[i];
+    if((ctx->game.puzzle & site->flags) != site->flags)
+    {
+      for(i32 place = 0; place < solver->place_count; place++)
+      {
+        i32 tile = solver->place_tiles[place];
+        if(get_tile(ctx, tile % ROOM_WIDTH, tile / ROOM_WIDTH) == site->glyph)
+        {
+          places |= 1 << place;
+        }
+      }
+    }
+  }
+
+  u32 walk_turns = places ? SEARCH_UNREACHABLE : get_open_walk_turns(solver, player_tile, false, solver->escape_tile, false);
+  for(i32 next = 0; next < solver->place_count; next++)
+  {
+    if((places & (1 << next)) && !(places & solver->places_before[next]))
+    {
+      u32 turns = get_open_walk_turns(solver, player_tile, false, solver->place_tiles[next], true) +
+                  get_tour_turns(solver, places & ~(1 << next), next);
+      walk_turns = turns < walk_turns ? turns : walk_turns;
+    }
+  }
+
+  walk_turns = spread_turns > walk_turns ? spread_turns : walk_turns;
+  if(walk_turns >= SEARCH_UNREACHABLE)
+  {
+    return SEARCH_UNREACHABLE;
+  }
+
+  // Pouring the water on the stone door and opening it each knock the player
+  // back a tile, which can save a step if there's still something to do
+  // behind them
+  if(!is_puzzle_flag_set(ctx, puzzle_first_door_dihydrogen_monoxide_added) && walk_turns)
+  {
+    walk_turns--;
+  }
+
+  if(!is_puzzle_flag_set(ctx, puzzle_first_door_open) && walk_turns)
+  {
+    walk_turns--;
+  }
+
+  return action_turns + walk_turns;
+}
+
+internal void
+grow_solver_slots(solver_t *solver, u32 slot_count)
+{
+  u64 *old_slots = solver->slots;
+  u32 old_slot_count = old_slots ? solver->slot_mask + 1 : 0;
+
+  solver->slots = calloc(slot_count, sizeof(u64));
+  solver->slot_mask = slot_count - 1;
+
+  for(u32 i = 0; i < old_slot_count; i++)
+  {
+    if(old_slots[i])
+    {
+      u32 slot = (u32)(old_slots[i] >> 32) & solver->slot_mask;
+      while(solver->slots[slot])
+      {
+        slot = (slot + 1) & solver->slot_mask;
+      }
+
+      solver->slots[slot] = old_slots[i];
+    }
+  }
+
+  free(old_slots);
+}
+
+internal inline u32
+get_solve_total(solver_t *solver, u32 turns, u32 estimate)
+{
+  return turns + ((estimate * solver->weight) / SOLVE_WEIGHT_ONE);
+}
+
+internal void
+push_solve_bucket(solver_t *solver, u32 total, u32 node_i)
+{
+  // A node found again through a shorter way can land behind the bucket
+  // that's being expanded, it's expanded along with that one instead
+  if(total < solver->expanding_bucket)
+  {
+    total = solver->expanding_bucket;
+  }
+
+  solve_bucket_t *bucket = &solver->buckets[total];
+  if(bucket->count == bucket->capacity)
+  {
+    bucket->capacity = bucket->capacity ? bucket->capacity * 2 : 256;
+    bucket->nodes = realloc(bucket->nodes, bucket->capacity * sizeof(u32));
+  }
+
+  bucket->nodes[bucket->count++] = node_i;
+}
+
+// Keep the shortest way to the state
+internal void
+add_solve_node(solver_t *solver, state_code_t *code, u32 parent, action_t action, u32 turns, u32 estimate)
+{
+  if(estimate == SEARCH_UNREACHABLE || get_solve_total(solver, turns, estimate) >= SOLVE_MAX_TURNS)
+  {
+    return;
+  }
+
+  if((solver->node_count + 1) * 2 > solver->slot_mask + 1)
+  {
+    grow_solver_slots(solver, (solver->slot_mask + 1) * 2);
+  }
+
+  u64 hash = hash_state_code(code);
+  u32 slot = (u32)(hash >> 32) & solver->slot_mask;
+
+  while(solver->slots[slot])
+  {
+    u64 entry = solver->slots[slot];
+    solve_node_t *node = &solver->nodes[(u32)entry - 1];
+
+    if((entry >> 32) == (hash >> 32) && are_state_codes_equal(&node->code, code))
+    {
+      if(turns < node->turns)
+      {
+        node->parent = parent;
+        node->action = action;
+        node->turns = (u16)turns;
+        node->settled = false;
+        push_solve_bucket(solver, get_solve_total(solver, turns, node->estimate), (u32)entry - 1);
+      }
+
+      return;
+    }
+
+    slot = (slot + 1) & solver->slot_mask;
+  }
+
+  if(solver->node_count == solver->max_nodes)
+  {
+    return;
+  }
+
+  if(solver->node_count == solver->node_capacity)
+  {
+    solver->node_capacity *= 2;
+    solver->nodes = realloc(solver->nodes, solver->node_capacity * sizeof(solve_node_t));
+  }
+
+  solve_node_t *node = &solver->nodes[solver->node_count++];
+  node->code = *code;
+  node->parent = parent;
+  node->action = action;
+  node->turns = (u16)turns;
+  node->estimate = (u16)estimate;
+  node->settled = false;
+
+  solver->slots[slot] = (hash & 0xFFFFFFFF00000000) | solver->node_count;
+  push_solve_bucket(solver, get_solve_total(solver, turns, estimate), solver->node_count - 1);
+}
+
+internal void
+add_solve_child(rebirth_ctx_t *ctx, void *data, state_code_t *code, action_t action, u32 turns)
+{
+  solver_t *solver = (solver_t *)data;
+  turns += solver->nodes[solver->expanding_node].turns;
+
+  if(get_action_kind(action) == action_escape)
+  {
+    if(turns < solver->escape_turns)
+    {
+      solver->escape_turns = turns;
+      solver->escape_node = solver->expanding_node;
+      solver->escape_action = action;
+    }
+  }
+  else
+  {
+    add_solve_node(solver, code, solver->expanding_node, action, turns, get_turns_estimate(ctx, solver));
+  }
+}
+
+// Set up the estimate for the level
+internal void
+set_solver_level(rebirth_ctx_t *ctx, solver_t *solver)
+{
+  free(solver->tour_turns);
+  solver->place_count = 0;
+  memset(solver->places_before, 0, sizeof(solver->places_before));
+
+  init_game_data(ctx);
+  ctx->game.state = state_play;
+  build_open_distances(ctx, solver);
+  build_solve_places(ctx, solver);
+}
+
+internal void
+init_solver(rebirth_ctx_t *ctx, solver_t *solver, u32 max_states)
+{
+  memset(solver, 0, sizeof(solver_t));
+  solver->max_nodes = max_states;
+  solver->node_capacity = 1 << 16;
+  solver->nodes = malloc(solver->node_capacity * sizeof(solve_node_t));
+  solver->weight = SOLVE_WEIGHT_ONE;
+  grow_solver_slots(solver, 1 << 17);
+
+  set_solver_level(ctx, solver);
+}
+
+internal void
+free_solver(solver_t *solver)
+{
+  for(u32 i = 0; i < SOLVE_MAX_TURNS; i++)
+  {
+    free(solver->buckets[i].nodes);
+  }
+
+  free(solver->nodes);
+  free(solver->slots);
+  free(solver->tour_turns);
+}
+
+// Best first on turns plus estimate
+internal u32
+solve(rebirth_ctx_t *ctx, solver_t *solver, state_code_t *start)
+{
+  solver->node_count = 0;
+  solver->expanding_bucket = 0;
+  memset(solver->slots, 0, (solver->slot_mask + 1) * sizeof(u64));
+  for(u32 i = 0; i < SOLVE_MAX_TURNS; i++)
+  {
+    solver->buckets[i].count = 0;
+  }
+
+  solver->escape_turns = SOLVE_MAX_TURNS;
+  if(solver->escape_tile < 0)
+  {
+    return solver->escape_turns;
+  }
+
+  decode_game_state(ctx, start);
+  add_solve_node(solver, start, 0, 0, 0, get_turns_estimate(ctx, solver));
+
+  search_expansion_t *expansion = calloc(1, sizeof(search_expansion_t));
+  expansion->add_child = add_solve_child;
+  expansion->data = solver;
+
+  for(u32 total = 0; total < solver->escape_turns; total++)
+  {
+    solver->expanding_bucket = total;
+    solve_bucket_t *bucket = &solver->buckets[total];
+
+    // Newest first, the nodes furthest along go before those that only
+    // estimate as well, so an escape at this total turns up sooner
+    while(bucket->count && solver->escape_turns > total)
+    {
+      if(solver->stop && __atomic_load_n(solver->stop, __ATOMIC_RELAXED))
+      {
+        free(expansion);
+        solver->escape_turns = SOLVE_MAX_TURNS;
+        return solver->escape_turns;
+      }
+
+      u32 node_i = bucket->nodes[--bucket->count];
+      solve_node_t *node = &solver->nodes[node_i];
+
+      if(!node->settled && get_solve_total(solver, node->turns, node->estimate) <= total)
+      {
+        node->settled = true;
+        solver->expanding_node = node_i;
+        expand_search_state(ctx, expansion, &node->code);
+      }
+    }
+  }
+
+  free(expansion);
+  return solver->escape_turns;
+}
+
+// Actions of the escape in order
+shared i32
+get_solution_actions(solver_t *solver, action_t *actions, i32 max_action_count)
+{
+  i32 action_count = 1;
+  for(u32 node_i = solver->escape_node; node_i; node_i = solver->nodes[node_i].parent)
+  {
+    action_count++;
+  }
+
+  i32 at = action_count - 1;
+  if(at < max_action_count)
+  {
+    actions[at] = solver->escape_action;
+  }
+
+  for(u32 node_i = solver->escape_node; node_i; node_i = solver->nodes[node_i].parent)
+  {
+    if(--at < max_action_count)
+    {
+      actions[at] = solver->nodes[node_i].action;
+    }
+  }
+
+  return action_count;
+}